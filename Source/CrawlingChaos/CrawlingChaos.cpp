@@ -1,7 +1,62 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "CrawlingChaos.h"
+#include "Engine/World.h"
+#include "Materials/MaterialInstanceDynamic.h"
 #include "Modules/ModuleManager.h"
+#include "UObject/UObjectIterator.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogCrawlingChaos, Log, All);
+
+DEFINE_STAT(STAT_ShotsFired);
+DEFINE_STAT(STAT_TracesIssued);
+DEFINE_STAT(STAT_EffectsSpawned);
+DEFINE_STAT(STAT_PickupsTicking);
+DEFINE_STAT(STAT_LiveMIDs);
+DEFINE_STAT(STAT_PickupInstancesUpdated);
+DEFINE_STAT(STAT_ProjectilesAlive);
+
+uint64 GCrawlingChaosTracesIssued = 0;
+
+UE_TRACE_CHANNEL_DEFINE(CrawlingChaosChannel);
+
+CSV_DEFINE_CATEGORY_MODULE(CRAWLINGCHAOS_API, CrawlingChaos, true);
+
+int32 CountLiveMIDs(const UWorld* World)
+{
+	int32 Count = 0;
+	for (TObjectIterator<UMaterialInstanceDynamic> It; It; ++It)
+	{
+		if (IsValid(*It) && It->GetTypedOuter<UWorld>() == World)
+		{
+			++Count;
+		}
+	}
+	return Count;
+}
+
+namespace
+{
+	FAutoConsoleCommand CountMaterialInstancesCommand(
+		TEXT("CrawlingChaos.CountMIDs"),
+		TEXT("Log how many dynamic material instances are alive in each world"),
+		FConsoleCommandDelegate::CreateLambda([]()
+		{
+			TMap<const UWorld*, int32> CountPerWorld;
+			for (TObjectIterator<UMaterialInstanceDynamic> It; It; ++It)
+			{
+				if (IsValid(*It))
+				{
+					++CountPerWorld.FindOrAdd(It->GetTypedOuter<UWorld>());
+				}
+			}
+
+			for (const TPair<const UWorld*, int32>& Count : CountPerWorld)
+			{
+				UE_LOG(LogCrawlingChaos, Display, TEXT("%s: %d live dynamic material instances"),
+					   Count.Key ? *Count.Key->GetPathName() : TEXT("No world"), Count.Value);
+			}
+		}));
+}
 
 IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, CrawlingChaos, "CrawlingChaos" );
- 
\ No newline at end of file
@@ -3,3 +3,42 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+class UWorld;
+
+/** Gameplay hot paths: weapon fire, projectiles, effects and pickups. Shown with "stat CrawlingChaos" */
+DECLARE_STATS_GROUP(TEXT("CrawlingChaos"), STATGROUP_CrawlingChaos, STATCAT_Advanced);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Shots Fired"), STAT_ShotsFired, STATGROUP_CrawlingChaos, CRAWLINGCHAOS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Traces Issued"), STAT_TracesIssued, STATGROUP_CrawlingChaos, CRAWLINGCHAOS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Effects Spawned"), STAT_EffectsSpawned, STATGROUP_CrawlingChaos, CRAWLINGCHAOS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pickups Ticking"), STAT_PickupsTicking, STATGROUP_CrawlingChaos, CRAWLINGCHAOS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Live MIDs"), STAT_LiveMIDs, STATGROUP_CrawlingChaos, CRAWLINGCHAOS_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Pickup Instances Updated"), STAT_PickupInstancesUpdated, STATGROUP_CrawlingChaos, CRAWLINGCHAOS_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Projectiles Alive"), STAT_ProjectilesAlive, STATGROUP_CrawlingChaos, CRAWLINGCHAOS_API);
+
+/** Number of dynamic material instances alive in the world */
+CRAWLINGCHAOS_API int32 CountLiveMIDs(const UWorld* World);
+
+/** Every trace the game has issued since startup, readable in any build configuration. Game thread only */
+extern CRAWLINGCHAOS_API uint64 GCrawlingChaosTracesIssued;
+
+/** Trace channel for the game's CPU events; turn it on with -trace=cpu,CrawlingChaos */
+UE_TRACE_CHANNEL_EXTERN(CrawlingChaosChannel, CRAWLINGCHAOS_API);
+
+/** CSV profiler category for the game's custom stats */
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(CRAWLINGCHAOS_API, CrawlingChaos);
+
+/** Time the enclosing scope both as a cycle stat and as a CPU event on the CrawlingChaos trace channel */
+#define CRAWLINGCHAOS_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL_STR(#Stat, CrawlingChaosChannel)
+
+/** Count traces issued, both in the Traces Issued stat and in GCrawlingChaosTracesIssued */
+#define CRAWLINGCHAOS_COUNT_TRACES(Count) \
+	INC_DWORD_STAT_BY(STAT_TracesIssued, Count); \
+	GCrawlingChaosTracesIssued += (Count)
@@ -1,9 +1,11 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "CrawlingChaosCharacter.h"
+#include "CrawlingChaos.h"
 #include "CrawlingChaosProjectile.h"
 #include "Animation/AnimInstance.h"
 #include "Camera/CameraComponent.h"
+#include "Camera/PlayerCameraManager.h"
 #include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
 #include "GameFramework/InputSettings.h"
@@ -11,17 +13,25 @@
 #include "MotionControllerComponent.h"
 #include "GameFramework/CharacterMovementComponent.h"
 #include "Kismet/KismetMathLibrary.h"
+#include "InventoryComponent.h"
+#include "PickupSubsystem.h"
 #include "Weapon.h"
+#include "WeaponInstance.h"
 #include "NiagaraSystem.h"
 #include "NiagaraFunctionLibrary.h"
 
 DEFINE_LOG_CATEGORY_STATIC(LogFPChar, Warning, All);
 
+DECLARE_CYCLE_STAT(TEXT("Character Swap Weapons"), STAT_CharacterSwapWeapons, STATGROUP_CrawlingChaos);
+DECLARE_CYCLE_STAT(TEXT("Character Equip Weapon"), STAT_CharacterEquipWeapon, STATGROUP_CrawlingChaos);
+
 //////////////////////////////////////////////////////////////////////////
 // AMyProjectCharacter
 
 ACrawlingChaosCharacter::ACrawlingChaosCharacter() :
 	bCanFire(false),
+	MaxHealth(100.f),
+	Health(100.f),
 	StartingAmmoVal(120)
 {
 	// Set size for collision capsule
@@ -43,11 +53,14 @@ ACrawlingChaosCharacter::ACrawlingChaosCharacter() :
 	Mesh1P->SetRelativeRotation(FRotator(1.9f, -19.19f, 5.2f));
 	Mesh1P->SetRelativeLocation(FVector(-0.5f, -4.4f, -155.7f));
 
-	AmmoMap.Add(EAmmoType::EAT_Rifle, StartingAmmoVal);
-	AmmoMap.Add(EAmmoType::EAT_Pistol, StartingAmmoVal);
-	AmmoMap.Add(EAmmoType::EAT_Plasma, StartingAmmoVal);
-	AmmoMap.Add(EAmmoType::EAT_Shotgun, StartingAmmoVal);
-	AmmoMap.Add(EAmmoType::EAT_Rocket, StartingAmmoVal);
+	Inventory = CreateDefaultSubobject<UInventoryComponent>(TEXT("Inventory"));
+	Inventory->SetAmmo(EAmmoType::EAT_Rifle, StartingAmmoVal);
+	Inventory->SetAmmo(EAmmoType::EAT_Pistol, StartingAmmoVal);
+	Inventory->SetAmmo(EAmmoType::EAT_Plasma, StartingAmmoVal);
+	Inventory->SetAmmo(EAmmoType::EAT_Shotgun, StartingAmmoVal);
+	Inventory->SetAmmo(EAmmoType::EAT_Rocket, StartingAmmoVal);
+
+	WeaponActorClass = AWeapon::StaticClass();
 }
 
 void ACrawlingChaosCharacter::BeginPlay()
@@ -55,17 +68,35 @@ void ACrawlingChaosCharacter::BeginPlay()
 	// Call the base class  
 	Super::BeginPlay();
 
+	Health = MaxHealth;
+	OnHealthChanged.Broadcast(Health, MaxHealth);
+
 	if (DefaultWeaponClass)
 	{
-		const auto WeaponToAdd = GetWorld()->SpawnActor<AWeapon>(DefaultWeaponClass);
-		AddWeaponToInventory(WeaponToAdd);
-		EquipWeapon(WeaponToAdd);
+		const EWeaponType DefaultWeaponType = DefaultWeaponClass->GetDefaultObject<AWeapon>()->GetWeaponType();
+		EquipWeapon(AddWeaponToInventory(DefaultWeaponType));
+	}
+
+	// Pickups are found through the pickup subsystem rather than overlaps
+	if (UPickupSubsystem* Pickups = GetWorld()->GetSubsystem<UPickupSubsystem>())
+	{
+		Pickups->RegisterCollector(this);
 	}
 
 	// Show or hide the two versions of the gun based on whether or not we're using motion controllers.
 	Mesh1P->SetHiddenInGame(false, true);
 }
 
+void ACrawlingChaosCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UPickupSubsystem* Pickups = GetWorld()->GetSubsystem<UPickupSubsystem>())
+	{
+		Pickups->UnregisterCollector(this);
+	}
+	
+	Super::EndPlay(EndPlayReason);
+}
+
 /////////////////////////////////////////////////////////////////////////////
 /// Weapon equipping/swapping
 
@@ -91,42 +122,72 @@ void ACrawlingChaosCharacter::WeaponFourEquip()
 
 void ACrawlingChaosCharacter::SwapWeapons(EWeaponType WeaponTypeToSwap)
 {
-	if (EquippedWeapon == nullptr)
-	{
-		// Equip it and return immediately
-		EquipWeapon(WeaponInventory[WeaponTypeToSwap]);
-		return;
-	}
+	CRAWLINGCHAOS_SCOPE_CYCLE_COUNTER(STAT_CharacterSwapWeapons);
 	
-	if (!WeaponInventory.Contains(WeaponTypeToSwap)) return;
-	if (WeaponTypeToSwap == EquippedWeapon->GetWeaponType()) return;
+	UWeaponInstance* WeaponToSwap = Inventory->GetWeapon(WeaponTypeToSwap);
+	if (WeaponToSwap == nullptr) return;
+	if (EquippedWeapon && EquippedWeapon->GetInstance() == WeaponToSwap) return;
 
-	if (EquippedWeapon != nullptr)
-	{
-		// Set item state back to picked up
-		EquippedWeapon->SetItemState(EItemState::EIS_PickedUp);	
-	}
+	// The weapon actor stays in hand; only its mesh and definition change
+	EquipWeapon(WeaponToSwap, true);
+}
+
+void ACrawlingChaosCharacter::EquipWeapon(UWeaponInstance* WeaponToEquip, bool bSwapping)
+{
+	CRAWLINGCHAOS_SCOPE_CYCLE_COUNTER(STAT_CharacterEquipWeapon);
+	
+	if (WeaponToEquip == nullptr) return;
 
-	// Set the new Equipped weapon to the item in the map
-	EquipWeapon(WeaponInventory[WeaponTypeToSwap]);
+	AWeapon* WeaponActor = GetOrSpawnWeaponActor();
+	if (WeaponActor == nullptr) return;
+	
+	WeaponActor->SetInstance(WeaponToEquip);
+	OnEquippedWeaponChanged.Broadcast(WeaponToEquip);
 }
 
-void ACrawlingChaosCharacter::EquipWeapon(AWeapon* WeaponToEquip, bool bSwapping)
+AWeapon* ACrawlingChaosCharacter::GetOrSpawnWeaponActor()
 {
-	EquippedWeapon = WeaponToEquip;
+	if (EquippedWeapon != nullptr) return EquippedWeapon;
+	if (WeaponActorClass == nullptr) return nullptr;
+
+	// Deferred so it's already in the equipped state when it begins play, and never acts as a pickup
+	EquippedWeapon = GetWorld()->SpawnActorDeferred<AWeapon>(WeaponActorClass, GetActorTransform(), this, nullptr,
+															 ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	if (EquippedWeapon == nullptr) return nullptr;
+	
+	EquippedWeapon->SetPlayer(this);
 	EquippedWeapon->SetItemState(EItemState::EIS_Equipped);
-	EquippedWeapon->GetItemMesh()->AttachToComponent(Mesh1P, 
+	EquippedWeapon->FinishSpawning(GetActorTransform());
+	EquippedWeapon->AttachToComponent(Mesh1P, 
 		FAttachmentTransformRules(EAttachmentRule::SnapToTarget, true), 
 		TEXT("GripPoint"));
+	return EquippedWeapon;
 }
 
-void ACrawlingChaosCharacter::AddWeaponToInventory(AWeapon* WeaponToAdd)
+UWeaponInstance* ACrawlingChaosCharacter::GetEquippedWeapon() const
 {
-	if (WeaponInventory.Contains(WeaponToAdd->GetWeaponType())) return;
-	WeaponInventory.Add(WeaponToAdd->GetWeaponType(), WeaponToAdd);
-	WeaponToAdd->SetItemState(EItemState::EIS_PickedUp);
-	WeaponToAdd->SetPlayer(this);
-} 
+	return EquippedWeapon ? EquippedWeapon->GetInstance() : nullptr;
+}
+
+int32 ACrawlingChaosCharacter::GetAmmo(const EAmmoType AmmoType) const
+{
+	return Inventory->GetAmmo(AmmoType);
+}
+
+bool ACrawlingChaosCharacter::AlreadyHasWeapon(const EWeaponType WeaponType) const
+{
+	return Inventory->HasWeapon(WeaponType);
+}
+
+UWeaponInstance* ACrawlingChaosCharacter::AddWeaponToInventory(const EWeaponType WeaponType)
+{
+	return Inventory->AddWeapon(WeaponType);
+}
+
+void ACrawlingChaosCharacter::AddAmmoOfType(const EAmmoType AmmoType, const int32 AmmoAmount)
+{
+	Inventory->AddAmmo(AmmoType, AmmoAmount);
+}
 
 
 //////////////////////////////////////////////////////////////////////////
@@ -147,26 +208,53 @@ void ACrawlingChaosCharacter::SetupPlayerInputComponent(class UInputComponent* P
 	PlayerInputComponent->BindAction("Weapon4", IE_Pressed, this, &ACrawlingChaosCharacter::WeaponFourEquip);
 }
 
+/////////////////////////////////////////////////////////////////////////
+/// Health
+
+float ACrawlingChaosCharacter::TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent,
+										  AController* EventInstigator, AActor* DamageCauser)
+{
+	const float Damage = Super::TakeDamage(DamageAmount, DamageEvent, EventInstigator, DamageCauser);
+	if (Damage <= 0.f || Health <= 0.f) return Damage;
+
+	Health = FMath::Max(Health - Damage, 0.f);
+	OnHealthChanged.Broadcast(Health, MaxHealth);
+	return Damage;
+}
+
 /////////////////////////////////////////////////////////////////////////
 /// Weapon Fire
 
-void ACrawlingChaosCharacter::DecrementInventoryValue(const EAmmoType Type, int32 Amount)
+const FFireView& ACrawlingChaosCharacter::GetFireView() const
 {
-	if (EquippedWeapon->GetFireMode() == EFireMode::EFM_Burst)
+	if (CachedFireView.Frame == GFrameCounter) return CachedFireView;
+
+	// The camera manager's cached view is what was rendered; without one, fall back to our own camera
+	FMinimalViewInfo View;
+	const APlayerController* PlayerController = Cast<APlayerController>(GetController());
+	if (PlayerController && PlayerController->PlayerCameraManager)
 	{
-		for (size_t i = 0; i < Amount; i++)
-		{
-			if (AmmoMap[Type] != 0)
-			{
-				--AmmoMap[Type];
-			}
-		}
+		View = PlayerController->PlayerCameraManager->GetCameraCacheView();
 	}
 	else
 	{
-		--AmmoMap[Type];
+		FirstPersonCameraComponent->GetCameraView(0.f, View);
 	}
-	
+
+	const FRotationMatrix Axes{View.Rotation};
+	CachedFireView.Location = View.Location;
+	CachedFireView.Forward = Axes.GetScaledAxis(EAxis::X);
+	CachedFireView.Right = Axes.GetScaledAxis(EAxis::Y);
+	CachedFireView.Up = Axes.GetScaledAxis(EAxis::Z);
+	CachedFireView.TanHalfFOV = FMath::Tan(FMath::DegreesToRadians(View.FOV * 0.5f));
+	CachedFireView.Frame = GFrameCounter;
+	return CachedFireView;
+}
+
+void ACrawlingChaosCharacter::DecrementInventoryValue(const EAmmoType Type, int32 Amount)
+{
+	// One unit of ammo per round fired
+	Inventory->ConsumeAmmo(Type, Amount);
 }
 
 void ACrawlingChaosCharacter::PlayWeaponFireAnimation(UAnimMontage* AnimMontage) const
@@ -182,15 +270,15 @@ void ACrawlingChaosCharacter::PrimaryFireButtonPressed()
 {
 	// Avoid crashing the game lol
 	if (EquippedWeapon == nullptr) return;
-	if (AmmoMap[EquippedWeapon->GetAmmoType()] == 0) return;
+	if (Inventory->GetAmmo(EquippedWeapon->GetAmmoType()) == 0) return;
 
-	EquippedWeapon->SetStartFiring(true);
-	EquippedWeapon->OnFire();
+	EquippedWeapon->PullTrigger();
 }
 
 // Disabling this because you can't bind a button press function if it's const
 // ReSharper disable once CppMemberFunctionMayBeConst
 void ACrawlingChaosCharacter::PrimaryFireButtonReleased()
 {
-	EquippedWeapon->SetStartFiring(false);
+	if (EquippedWeapon == nullptr) return;
+	EquippedWeapon->ReleaseTrigger();
 }
@@ -6,6 +6,7 @@
 #include "Enums/AmmoType.h"
 #include "Enums/WeaponType.h"
 #include "GameFramework/Character.h"
+#include "WeaponSpread.h"
 
 #include "CrawlingChaosCharacter.generated.h"
 
@@ -19,6 +20,11 @@ class UAnimMontage;
 class USoundBase;
 class AWeapon;
 class UNiagaraSystem;
+class UInventoryComponent;
+class UWeaponInstance;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnEquippedWeaponChanged, UWeaponInstance*, Weapon);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnHealthChanged, float, Health, float, MaxHealth);
 
 UCLASS(config=Game)
 class ACrawlingChaosCharacter : public ACharacter
@@ -32,8 +38,15 @@ protected:
 	/** Begin Play override */
 	virtual void BeginPlay() override;
 
+	/** Stop collecting pickups once we're gone */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	// APawn interface
 	virtual void SetupPlayerInputComponent(UInputComponent* InputComponent) override;
+
+	/** Take the damage out of our health */
+	virtual float TakeDamage(float DamageAmount, FDamageEvent const& DamageEvent, AController* EventInstigator,
+							 AActor* DamageCauser) override;
 	
 	/** Called when the fire button is pressed */
 	void PrimaryFireButtonPressed();
@@ -41,11 +54,11 @@ protected:
 	/** Called when the fire button is released */
 	void PrimaryFireButtonReleased();
 
-	/** Called when equipping a weapon */
-	void EquipWeapon(AWeapon* WeaponToEquip, bool bSwapping = false);
+	/** Called when equipping a weapon; the weapon actor in hand takes on the carried weapon */
+	void EquipWeapon(UWeaponInstance* WeaponToEquip, bool bSwapping = false);
 
-	/** Swap the current weapon with the intended one */
-	void SwapWeapons(EWeaponType WeaponTypeToSwap);
+	/** Get the weapon actor in hand, spawning it the first time */
+	AWeapon* GetOrSpawnWeaponActor();
 
 	/** Equip the weapon in the first slot */
 	void WeaponOneEquip();
@@ -64,8 +77,13 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = true))
 	AWeapon* EquippedWeapon;
 
+	/** Weapon the character starts out carrying */
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = true))
 	TSubclassOf<AWeapon> DefaultWeaponClass;
+
+	/** Class of the one weapon actor held in hand; it takes on whichever carried weapon is equipped */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = true))
+	TSubclassOf<AWeapon> WeaponActorClass;
 	
 	/** Pawn mesh: 1st person view (arms; seen only by self) */
 	UPROPERTY(VisibleDefaultsOnly, Category=Mesh)
@@ -75,15 +93,21 @@ private:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	UCameraComponent* FirstPersonCameraComponent;
 
-	/** Ammo map */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
-	TMap<EAmmoType, int32> AmmoMap;
+	/** Ammo and weapons the character is currently holding */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Inventory, meta = (AllowPrivateAccess = "true"))
+	UInventoryComponent* Inventory;
+
+	/** Health the character spawns with */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly, Category = Health, meta = (AllowPrivateAccess = true))
+	float MaxHealth;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Health, meta = (AllowPrivateAccess = true))
+	float Health;
 	
 	uint32 StartingAmmoVal;
 
-	/** Inventory of weapons the character is currently holding */
-	UPROPERTY()
-	TMap<EWeaponType, AWeapon*> WeaponInventory;
+	/** Camera view weapons fire along, refreshed at most once per frame */
+	mutable FFireView CachedFireView;
 public:
 	/////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// Getters
@@ -94,38 +118,48 @@ public:
 	/** Returns FirstPersonCameraComponent sub-object **/
 	UCameraComponent* GetFirstPersonCameraComponent() const { return FirstPersonCameraComponent; }
 
-	int32 GetAmmo(EAmmoType AmmoType)
-	{
-		if (AmmoMap.Contains(AmmoType))
-		{
-			return AmmoMap[AmmoType];
-		}
-		return 0;
-	}
+	/** Returns Inventory sub-object **/
+	UInventoryComponent* GetInventory() const { return Inventory; }
+
+	/** Returns the class of the weapon the character starts with **/
+	TSubclassOf<AWeapon> GetDefaultWeaponClass() const { return DefaultWeaponClass; }
+
+	/** Returns the weapon actor in hand, or null before the first weapon is equipped */
+	AWeapon* GetWeaponActor() const { return EquippedWeapon; }
+
+	/** Returns the carried weapon in hand, or null if there isn't one */
+	UWeaponInstance* GetEquippedWeapon() const;
+
+	float GetHealth() const { return Health; }
+	float GetMaxHealth() const { return MaxHealth; }
+
+	/** Returns the camera view for this frame, captured the first time it's asked for */
+	const FFireView& GetFireView() const;
+
+	int32 GetAmmo(EAmmoType AmmoType) const;
 
 	/** Returns true if the player already has the weapon of that type, or false if not */
-	bool AlreadyHasWeapon(EWeaponType WeaponType) const
-	{
-		return WeaponInventory.Contains(WeaponType);
-	};
-
-	void AddWeaponToInventory(AWeapon* WeaponToAdd);
-
-	void AddAmmoOfType(EAmmoType AmmoType, int32 AmmoAmount) 
-	{
-		if (AmmoMap.Contains(AmmoType))
-		{
-			AmmoMap[AmmoType] += AmmoAmount;
-		}
-		else
-		{
-			AmmoMap.Add(AmmoType, AmmoAmount);
-		}
-	}
+	bool AlreadyHasWeapon(EWeaponType WeaponType) const;
+
+	/** Swap the current weapon with the intended one */
+	void SwapWeapons(EWeaponType WeaponTypeToSwap);
+
+	/** Start carrying a weapon of the given type. Returns null if one is already carried */
+	UWeaponInstance* AddWeaponToInventory(EWeaponType WeaponType);
+
+	void AddAmmoOfType(EAmmoType AmmoType, int32 AmmoAmount);
 
 	/** Decrement the AmmoType by the input value Amount */
 	void DecrementInventoryValue(EAmmoType Type, int32 Amount);
 
 	void PlayWeaponFireAnimation(UAnimMontage* AnimMontage) const;
+
+	/** Broadcast whenever a different carried weapon is put in hand. Ammo changes come from the inventory */
+	UPROPERTY(BlueprintAssignable, Category = Combat)
+	FOnEquippedWeaponChanged OnEquippedWeaponChanged;
+
+	/** Broadcast whenever health changes */
+	UPROPERTY(BlueprintAssignable, Category = Health)
+	FOnHealthChanged OnHealthChanged;
 };
 
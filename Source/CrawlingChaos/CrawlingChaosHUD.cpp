@@ -1,10 +1,8 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "CrawlingChaosHUD.h"
-#include "Engine/Canvas.h"
 #include "Engine/Texture2D.h"
-#include "TextureResource.h"
-#include "CanvasItem.h"
+#include "PlayerHUDWidget.h"
 #include "UObject/ConstructorHelpers.h"
 
 ACrawlingChaosHUD::ACrawlingChaosHUD()
@@ -12,24 +10,21 @@ ACrawlingChaosHUD::ACrawlingChaosHUD()
 	// Set the crosshair texture
 	static ConstructorHelpers::FObjectFinder<UTexture2D> CrosshairTexObj(TEXT("Texture2D'/Game/_Game/Character/Textures/FirstPersonCrosshair.FirstPersonCrosshair'"));
 	CrosshairTex = CrosshairTexObj.Object;
+
+	HUDWidgetClass = UPlayerHUDWidget::StaticClass();
 }
 
 
-void ACrawlingChaosHUD::DrawHUD()
+void ACrawlingChaosHUD::BeginPlay()
 {
-	Super::DrawHUD();
-
-	// Draw very simple crosshair
+	Super::BeginPlay();
 
-	// find center of the Canvas
-	const FVector2D Center(Canvas->ClipX * 0.5f, Canvas->ClipY * 0.5f);
+	// The crosshair is part of the widget now, so nothing has to be drawn on the canvas every frame
+	if (HUDWidgetClass == nullptr || PlayerOwner == nullptr) return;
 
-	// offset by half the texture's dimensions so that the center of the texture aligns with the center of the Canvas
-	const FVector2D CrosshairDrawPosition( (Center.X),
-										   (Center.Y + 20.0f));
+	HUDWidget = CreateWidget<UPlayerHUDWidget>(PlayerOwner, HUDWidgetClass);
+	if (HUDWidget == nullptr) return;
 
-	// draw the crosshair
-	FCanvasTileItem TileItem( CrosshairDrawPosition, CrosshairTex->Resource, FLinearColor::White);
-	TileItem.BlendMode = SE_BLEND_Translucent;
-	Canvas->DrawItem( TileItem );
+	HUDWidget->SetCrosshairTexture(CrosshairTex);
+	HUDWidget->AddToViewport();
 }
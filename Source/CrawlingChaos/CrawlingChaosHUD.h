@@ -6,6 +6,8 @@
 #include "GameFramework/HUD.h"
 #include "CrawlingChaosHUD.generated.h"
 
+class UPlayerHUDWidget;
+
 UCLASS()
 class ACrawlingChaosHUD : public AHUD
 {
@@ -14,12 +16,20 @@ class ACrawlingChaosHUD : public AHUD
 public:
 	ACrawlingChaosHUD();
 
-	/** Primary draw call for the HUD */
-	virtual void DrawHUD() override;
+protected:
+	/** Put the HUD widget on screen */
+	virtual void BeginPlay() override;
 
 private:
 	/** Crosshair asset pointer */
+	UPROPERTY()
 	class UTexture2D* CrosshairTex;
 
+	/** Widget the HUD is drawn with; it only repaints when the character reports a change */
+	UPROPERTY(EditDefaultsOnly, Category = HUD)
+	TSubclassOf<UPlayerHUDWidget> HUDWidgetClass;
+
+	UPROPERTY()
+	UPlayerHUDWidget* HUDWidget;
 };
 
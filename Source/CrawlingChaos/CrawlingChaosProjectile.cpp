@@ -3,8 +3,18 @@
 #include "CrawlingChaosProjectile.h"
 #include "GameFramework/ProjectileMovementComponent.h"
 #include "Components/SphereComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "ProjectilePoolSubsystem.h"
 
-ACrawlingChaosProjectile::ACrawlingChaosProjectile() 
+ACrawlingChaosProjectile::ACrawlingChaosProjectile() :
+	bRequiresActor(true),
+	SimulatedMesh(nullptr),
+	PoolPrewarmCount(32),
+	bExplodeOnImpact(false),
+	PooledCollisionEnabled(ECollisionEnabled::QueryOnly),
+	bPooled(false),
+	bActiveInPool(false)
 {
 	// Use a sphere as a simple collision representation
 	CollisionComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
@@ -35,7 +45,16 @@ ACrawlingChaosProjectile::ACrawlingChaosProjectile()
 
 void ACrawlingChaosProjectile::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
 {
-	Destroy();
+	if (bExplodeOnImpact)
+	{
+		if (UExplosionSubsystem* Explosions = GetWorld()->GetSubsystem<UExplosionSubsystem>())
+		{
+			const APawn* OwnerPawn = Cast<APawn>(GetOwner());
+			Explosions->QueueExplosion(GetActorLocation(), ExplosionSettings, this,
+									   OwnerPawn ? OwnerPawn->GetController() : nullptr);
+		}
+	}
+	Recycle();
 }
 
 void ACrawlingChaosProjectile::BeginPlay()
@@ -44,3 +63,65 @@ void ACrawlingChaosProjectile::BeginPlay()
 
 	CollisionComp->IgnoreActorWhenMoving(GetOwner(), true);
 }
+
+void ACrawlingChaosProjectile::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	PooledCollisionEnabled = CollisionComp->GetCollisionEnabled();
+}
+
+void ACrawlingChaosProjectile::LifeSpanExpired()
+{
+	if (bPooled)
+	{
+		Recycle();
+		return;
+	}
+	Super::LifeSpanExpired();
+}
+
+void ACrawlingChaosProjectile::Recycle()
+{
+	UProjectilePoolSubsystem* Pool = bPooled ? GetWorld()->GetSubsystem<UProjectilePoolSubsystem>() : nullptr;
+	if (Pool)
+	{
+		Pool->Release(this);
+	}
+	else
+	{
+		Destroy();
+	}
+}
+
+void ACrawlingChaosProjectile::ActivateFromPool(const FVector& Location, const FRotator& Rotation, AActor* NewOwner)
+{
+	bActiveInPool = true;
+
+	SetOwner(NewOwner);
+	CollisionComp->ClearMoveIgnoreActors();
+	CollisionComp->IgnoreActorWhenMoving(NewOwner, true);
+	SetActorLocationAndRotation(Location, Rotation, false, nullptr, ETeleportType::ResetPhysics);
+	
+	CollisionComp->SetCollisionEnabled(PooledCollisionEnabled);
+	SetActorHiddenInGame(false);
+
+	// The movement component drops its updated component once it stops simulating, so hook it back up
+	ProjectileMovement->SetUpdatedComponent(CollisionComp);
+	ProjectileMovement->Velocity = Rotation.Vector() * ProjectileMovement->InitialSpeed;
+	ProjectileMovement->Activate(true);
+	
+	SetLifeSpan(InitialLifeSpan);
+}
+
+void ACrawlingChaosProjectile::DeactivateToPool()
+{
+	bPooled = true;
+	bActiveInPool = false;
+
+	SetLifeSpan(0.f);
+	ProjectileMovement->StopMovementImmediately();
+	ProjectileMovement->Deactivate();
+	CollisionComp->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	SetActorHiddenInGame(true);
+}
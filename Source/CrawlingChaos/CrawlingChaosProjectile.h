@@ -3,11 +3,13 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "ExplosionSubsystem.h"
 #include "GameFramework/Actor.h"
 #include "CrawlingChaosProjectile.generated.h"
 
 class USphereComponent;
 class UProjectileMovementComponent;
+class UStaticMesh;
 
 UCLASS(config=Game)
 class ACrawlingChaosProjectile : public AActor
@@ -34,7 +36,65 @@ public:
 	/** Returns ProjectileMovement sub-object **/
 	UProjectileMovementComponent* GetProjectileMovement() const { return ProjectileMovement; }
 
+	/** Returns how many of this projectile the pool keeps ready **/
+	int32 GetPoolPrewarmCount() const { return PoolPrewarmCount; }
+	/** Returns true if this projectile has to be spawned as a full actor **/
+	bool RequiresActor() const { return bRequiresActor; }
+	/** Returns the mesh drawn for this projectile when the projectile manager simulates it **/
+	UStaticMesh* GetSimulatedMesh() const { return SimulatedMesh; }
+	/** Returns true if this projectile detonates when it hits something **/
+	bool ExplodesOnImpact() const { return bExplodeOnImpact; }
+	/** Returns how this projectile's detonation hits **/
+	const FExplosionSettings& GetExplosionSettings() const { return ExplosionSettings; }
+	/** Returns true if this projectile came out of the pool and is currently in flight **/
+	bool IsActiveInPool() const { return bActiveInPool; }
+
+	/** Move to the given location and start flying again */
+	void ActivateFromPool(const FVector& Location, const FRotator& Rotation, AActor* NewOwner);
+
+	/** Stop moving, colliding and rendering until the pool hands us out again */
+	void DeactivateToPool();
+
 protected:
 	virtual void BeginPlay() override;
+
+	virtual void PostInitializeComponents() override;
+
+	/** Pooled projectiles go back to the pool instead of being destroyed */
+	virtual void LifeSpanExpired() override;
+
+	/** Return to the pool if we came from it, otherwise destroy */
+	void Recycle();
+
+	/** Does this projectile need its own actor for gameplay callbacks? If not, the projectile manager
+	 *  simulates it in bulk and draws it through an instanced mesh */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	bool bRequiresActor;
+
+	/** Mesh instanced for this projectile while the projectile manager simulates it */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	UStaticMesh* SimulatedMesh;
+
+	/** How many of this projectile the pool spawns up front */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	int32 PoolPrewarmCount;
+
+	/** Does this projectile detonate when it hits something? */
+	UPROPERTY(EditDefaultsOnly, Category=Explosion)
+	bool bExplodeOnImpact;
+
+	/** Damage and impulse of the detonation */
+	UPROPERTY(EditDefaultsOnly, Category=Explosion, meta = (EditCondition = "bExplodeOnImpact"))
+	FExplosionSettings ExplosionSettings;
+
+private:
+	/** Collision setting to restore when the pool hands us out */
+	TEnumAsByte<ECollisionEnabled::Type> PooledCollisionEnabled;
+
+	/** Does this projectile belong to the pool? */
+	bool bPooled;
+
+	/** Is this pooled projectile currently in flight? */
+	bool bActiveInPool;
 };
 
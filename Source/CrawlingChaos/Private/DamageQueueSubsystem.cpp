@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "DamageQueueSubsystem.h"
+
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+
+void UDamageQueueSubsystem::Deinitialize()
+{
+	OnBeforeDispatch.Clear();
+	PendingDamage.Reset();
+	VictimIndices.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UDamageQueueSubsystem::IsTickable() const
+{
+	return PendingDamage.Num() > 0;
+}
+
+TStatId UDamageQueueSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UDamageQueueSubsystem, STATGROUP_Tickables);
+}
+
+void UDamageQueueSubsystem::QueueDamage(AActor* Victim, const float Amount, const FHitResult& Hit,
+										const FVector& ShotDirection, AController* Instigator, AActor* DamageCauser,
+										const TSubclassOf<UDamageType> DamageTypeClass)
+{
+	if (!IsValid(Victim) || Amount <= 0.f || !Victim->CanBeDamaged()) return;
+
+	int32& Index = VictimIndices.FindOrAdd(Victim, INDEX_NONE);
+	if (Index == INDEX_NONE)
+	{
+		Index = PendingDamage.AddDefaulted();
+		PendingDamage[Index].Victim = Victim;
+	}
+
+	FQueuedDamage& Damage = PendingDamage[Index];
+	Damage.Amount += Amount;
+	++Damage.NumHits;
+	if (Amount > Damage.StrongestAmount)
+	{
+		Damage.StrongestAmount = Amount;
+		Damage.Hit = Hit;
+		Damage.ShotDirection = ShotDirection;
+		Damage.Instigator = Instigator;
+		Damage.DamageCauser = DamageCauser;
+		Damage.DamageTypeClass = DamageTypeClass;
+	}
+}
+
+// Called once per frame while damage is pending, after every actor has ticked
+void UDamageQueueSubsystem::Tick(float DeltaTime)
+{
+	OnBeforeDispatch.Broadcast();
+	
+	// Anything queued while dispatching (deaths setting off explosions, say) goes out next frame
+	TArray<FQueuedDamage> Dispatching{MoveTemp(PendingDamage)};
+	PendingDamage.Reset();
+	VictimIndices.Reset();
+
+	for (const FQueuedDamage& Damage : Dispatching)
+	{
+		AActor* Victim = Damage.Victim.Get();
+		if (!IsValid(Victim)) continue;
+
+		const TSubclassOf<UDamageType> DamageType = Damage.DamageTypeClass ? Damage.DamageTypeClass : TSubclassOf<UDamageType>(UDamageType::StaticClass());
+		const FPointDamageEvent DamageEvent{Damage.Amount, Damage.Hit, Damage.ShotDirection, DamageType};
+		Victim->TakeDamage(Damage.Amount, DamageEvent, Damage.Instigator.Get(), Damage.DamageCauser.Get());
+	}
+}
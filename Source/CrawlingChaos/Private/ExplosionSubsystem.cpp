@@ -0,0 +1,269 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ExplosionSubsystem.h"
+
+#include "../CrawlingChaos.h"
+#include "DamageQueueSubsystem.h"
+#include "ImpulseAccumulatorSubsystem.h"
+#include "ProjectileManagerSubsystem.h"
+#include "../CrawlingChaosProjectile.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+#include "GameFramework/Pawn.h"
+
+float FExplosionSettings::GetFalloff(const float Distance) const
+{
+	if (Distance >= OuterRadius) return 0.f;
+	if (Distance <= InnerRadius) return 1.f;
+
+	const float Alpha = (Distance - InnerRadius) / FMath::Max(OuterRadius - InnerRadius, KINDA_SMALL_NUMBER);
+	return FMath::Pow(1.f - Alpha, DamageFalloff);
+}
+
+void UExplosionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Simulated rockets have no actor to explode from, so listen for their impacts
+	UProjectileManagerSubsystem* ProjectileManager = Cast<UProjectileManagerSubsystem>(
+		Collection.InitializeDependency(UProjectileManagerSubsystem::StaticClass()));
+	if (ProjectileManager)
+	{
+		ProjectileImpactHandle = ProjectileManager->OnProjectileImpact.AddUObject(this, &UExplosionSubsystem::OnSimulatedProjectileImpact);
+	}
+
+	// Tickables run in no particular order, so make sure last frame's blasts are in before the damage goes out
+	UDamageQueueSubsystem* DamageQueue = Cast<UDamageQueueSubsystem>(
+		Collection.InitializeDependency(UDamageQueueSubsystem::StaticClass()));
+	if (DamageQueue)
+	{
+		DamageDispatchHandle = DamageQueue->OnBeforeDispatch.AddUObject(this, &UExplosionSubsystem::ResolveTargetsIfReady);
+	}
+}
+
+void UExplosionSubsystem::Deinitialize()
+{
+	if (UProjectileManagerSubsystem* ProjectileManager = GetWorld()->GetSubsystem<UProjectileManagerSubsystem>())
+	{
+		ProjectileManager->OnProjectileImpact.Remove(ProjectileImpactHandle);
+	}
+	if (UDamageQueueSubsystem* DamageQueue = GetWorld()->GetSubsystem<UDamageQueueSubsystem>())
+	{
+		DamageQueue->OnBeforeDispatch.Remove(DamageDispatchHandle);
+	}
+	QueuedExplosions.Reset();
+	PendingExplosions.Reset();
+	PendingTargets.Reset();
+	
+	Super::Deinitialize();
+}
+
+bool UExplosionSubsystem::IsTickable() const
+{
+	return QueuedExplosions.Num() > 0 || PendingExplosions.Num() > 0;
+}
+
+TStatId UExplosionSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UExplosionSubsystem, STATGROUP_Tickables);
+}
+
+void UExplosionSubsystem::QueueExplosion(const FVector& Origin, const FExplosionSettings& Settings,
+										 AActor* DamageCauser, AController* InstigatorController)
+{
+	if (Settings.OuterRadius <= 0.f) return;
+	
+	FQueuedExplosion& Explosion = QueuedExplosions.AddDefaulted_GetRef();
+	Explosion.Origin = Origin;
+	Explosion.Settings = Settings;
+	Explosion.DamageCauser = DamageCauser;
+	Explosion.InstigatorController = InstigatorController;
+}
+
+void UExplosionSubsystem::OnSimulatedProjectileImpact(const TSubclassOf<ACrawlingChaosProjectile> ProjectileClass,
+													  AActor* ProjectileOwner, const FHitResult& Hit)
+{
+	const ACrawlingChaosProjectile* ProjectileDefaults = ProjectileClass ? ProjectileClass->GetDefaultObject<ACrawlingChaosProjectile>() : nullptr;
+	if (ProjectileDefaults == nullptr || !ProjectileDefaults->ExplodesOnImpact()) return;
+
+	// The sweep stops with the projectile's centre just off the surface, which keeps the origin out of the wall
+	const APawn* OwnerPawn = Cast<APawn>(ProjectileOwner);
+	QueueExplosion(Hit.Location, ProjectileDefaults->GetExplosionSettings(), ProjectileOwner,
+				   OwnerPawn ? OwnerPawn->GetController() : nullptr);
+}
+
+// Called once per frame while explosions are queued or waiting on traces
+void UExplosionSubsystem::Tick(float DeltaTime)
+{
+	ResolveTargetsIfReady();
+	
+	if (QueuedExplosions.Num() > 0)
+	{
+		GatherTargets();
+	}
+}
+
+void UExplosionSubsystem::ResolveTargetsIfReady()
+{
+	// Last frame's traces are back by now; anything sent this frame has to wait for the next
+	if (PendingExplosions.Num() > 0 && PendingTraceFrame != GFrameCounter)
+	{
+		ResolveTargets();
+	}
+}
+
+void UExplosionSubsystem::GatherTargets()
+{
+	UWorld* World = GetWorld();
+	PendingExplosions = MoveTemp(QueuedExplosions);
+	QueuedExplosions.Reset();
+	PendingTargets.Reset();
+	PendingTraceFrame = GFrameCounter;
+
+	// Detonations whose spheres touch share a cluster, and every cluster gets one overlap query
+	TArray<FSphere, TInlineAllocator<8>> ClusterBounds;
+	TArray<TArray<int32, TInlineAllocator<8>>, TInlineAllocator<8>> ClusterMembers;
+	for (int32 ExplosionIndex = 0; ExplosionIndex < PendingExplosions.Num(); ++ExplosionIndex)
+	{
+		const FQueuedExplosion& Explosion = PendingExplosions[ExplosionIndex];
+		const FSphere Sphere{Explosion.Origin, Explosion.Settings.OuterRadius};
+		const int32 ClusterIndex = ClusterBounds.IndexOfByPredicate([&Sphere](const FSphere& Bounds)
+		{
+			return Bounds.Intersects(Sphere);
+		});
+		if (ClusterIndex == INDEX_NONE)
+		{
+			ClusterBounds.Add(Sphere);
+			ClusterMembers.AddDefaulted_GetRef().Add(ExplosionIndex);
+		}
+		else
+		{
+			ClusterBounds[ClusterIndex] += Sphere;
+			ClusterMembers[ClusterIndex].Add(ExplosionIndex);
+		}
+	}
+
+	const FCollisionObjectQueryParams ObjectParams{FCollisionObjectQueryParams::AllDynamicObjects};
+	TArray<FOverlapResult> Overlaps;
+	TArray<UPrimitiveComponent*> Components;
+	TArray<FVector> BoundsMin;
+	TArray<FVector> BoundsMax;
+	TArray<float> DistancesSquared;
+	for (int32 ClusterIndex = 0; ClusterIndex < ClusterBounds.Num(); ++ClusterIndex)
+	{
+		const FSphere& Bounds = ClusterBounds[ClusterIndex];
+		Overlaps.Reset();
+		World->OverlapMultiByObjectType(Overlaps, Bounds.Center, FQuat::Identity, ObjectParams,
+										FCollisionShape::MakeSphere(Bounds.W),
+										FCollisionQueryParams{SCENE_QUERY_STAT(ExplosionOverlap), false});
+
+		// Every body once, however many of its shapes overlapped
+		Components.Reset();
+		BoundsMin.Reset();
+		BoundsMax.Reset();
+		for (const FOverlapResult& Overlap : Overlaps)
+		{
+			UPrimitiveComponent* Component = Overlap.GetComponent();
+			if (Component == nullptr || Components.Contains(Component)) continue;
+			
+			const FBox Box{Component->Bounds.GetBox()};
+			Components.Add(Component);
+			BoundsMin.Add(Box.Min);
+			BoundsMax.Add(Box.Max);
+		}
+		if (Components.Num() == 0) continue;
+		DistancesSquared.SetNumUninitialized(Components.Num(), false);
+
+		for (const int32 ExplosionIndex : ClusterMembers[ClusterIndex])
+		{
+			const FQueuedExplosion& Explosion = PendingExplosions[ExplosionIndex];
+			const FVector& Origin = Explosion.Origin;
+
+			// Distance from the origin to each body's bounds, as one pass of plain math over the arrays
+			for (int32 Index = 0; Index < Components.Num(); ++Index)
+			{
+				const FVector Outside{FVector::Max(FVector::Max(BoundsMin[Index] - Origin, Origin - BoundsMax[Index]), FVector::ZeroVector)};
+				DistancesSquared[Index] = Outside.SizeSquared();
+			}
+
+			const FCollisionQueryParams TraceParams{SCENE_QUERY_STAT(ExplosionLineOfSight), false, Explosion.DamageCauser.Get()};
+			for (int32 Index = 0; Index < Components.Num(); ++Index)
+			{
+				const float Falloff = Explosion.Settings.GetFalloff(FMath::Sqrt(DistancesSquared[Index]));
+				if (Falloff <= 0.f) continue;
+
+				FExplosionTarget& Target = PendingTargets.AddDefaulted_GetRef();
+				Target.Component = Components[Index];
+				Target.ExplosionIndex = ExplosionIndex;
+				Target.Falloff = Falloff;
+				Target.Location = Components[Index]->Bounds.Origin;
+				Target.Trace = World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Origin, Target.Location,
+															  ECollisionChannel::ECC_Visibility, TraceParams);
+				CRAWLINGCHAOS_COUNT_TRACES(1);
+			}
+		}
+	}
+}
+
+void UExplosionSubsystem::ResolveTargets()
+{
+	UWorld* World = GetWorld();
+	UImpulseAccumulatorSubsystem* Impulses = World->GetSubsystem<UImpulseAccumulatorSubsystem>();
+
+	// An actor takes the strongest hit on any of its components from each explosion, and the explosions add up
+	TMap<TPair<AActor*, int32>, const FExplosionTarget*> StrongestPerActorAndExplosion;
+	FTraceDatum TraceDatum;
+	for (const FExplosionTarget& Target : PendingTargets)
+	{
+		UPrimitiveComponent* Component = Target.Component.Get();
+		if (!IsValid(Component)) continue;
+
+		// Anything else in the way shields the target
+		AActor* Actor = Component->GetOwner();
+		if (World->QueryTraceData(Target.Trace, TraceDatum) && TraceDatum.OutHits.Num() > 0)
+		{
+			const FHitResult& Hit = TraceDatum.OutHits[0];
+			if (Hit.bBlockingHit && Hit.GetComponent() != Component && Hit.GetActor() != Actor) continue;
+		}
+
+		const FQueuedExplosion& Explosion = PendingExplosions[Target.ExplosionIndex];
+		if (Impulses)
+		{
+			const FVector Direction{(Target.Location - Explosion.Origin).GetSafeNormal()};
+			const float Speed = Explosion.Settings.ImpulsePerUnitMass * Target.Falloff;
+			Impulses->AddImpulseAtLocation(Component, NAME_None, Direction * Speed * Component->GetMass(), Target.Location);
+		}
+
+		if (Actor)
+		{
+			const FExplosionTarget*& Strongest = StrongestPerActorAndExplosion.FindOrAdd(TPair<AActor*, int32>{Actor, Target.ExplosionIndex}, nullptr);
+			if (Strongest == nullptr || Target.Falloff > Strongest->Falloff)
+			{
+				Strongest = &Target;
+			}
+		}
+	}
+
+	// The damage queue folds every explosion (and anything else) that reached an actor into one damage event
+	if (UDamageQueueSubsystem* DamageQueue = World->GetSubsystem<UDamageQueueSubsystem>())
+	{
+		for (const TPair<TPair<AActor*, int32>, const FExplosionTarget*>& Pair : StrongestPerActorAndExplosion)
+		{
+			AActor* Victim = Pair.Key.Key;
+			const FExplosionTarget& Target = *Pair.Value;
+			const FQueuedExplosion& Explosion = PendingExplosions[Target.ExplosionIndex];
+			const FExplosionSettings& Settings = Explosion.Settings;
+			const FVector Direction{(Target.Location - Explosion.Origin).GetSafeNormal()};
+			const FHitResult Hit{Victim, Target.Component.Get(), Target.Location, -Direction};
+			DamageQueue->QueueDamage(Victim, FMath::Lerp(Settings.MinimumDamage, Settings.BaseDamage, Target.Falloff),
+									 Hit, Direction, Explosion.InstigatorController.Get(),
+									 Explosion.DamageCauser.Get(), Settings.DamageTypeClass);
+		}
+	}
+
+	PendingExplosions.Reset();
+	PendingTargets.Reset();
+}
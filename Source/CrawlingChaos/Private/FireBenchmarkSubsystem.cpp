@@ -0,0 +1,325 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FireBenchmarkSubsystem.h"
+
+#include "../CrawlingChaos.h"
+#include "../CrawlingChaosCharacter.h"
+#include "Dom/JsonObject.h"
+#include "InventoryComponent.h"
+#include "RenderCore.h"
+#include "Weapon.h"
+#include "WeaponDefinitionSubsystem.h"
+#include "WeaponInstance.h"
+#include "Algo/Accumulate.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/App.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonSerializer.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogFireBenchmark, Log, All);
+
+namespace
+{
+	/** Shooters stand on a grid this far apart, and pickups are laid out on their own grid off to the side */
+	constexpr float GridSpacing{200.f};
+	const FVector PickupGridOffset{0.f, 3000.f, 0.f};
+
+	/** Enough ammo that nobody runs dry within a frame */
+	constexpr int32 BenchmarkAmmo{9999};
+
+	FAutoConsoleCommandWithWorldAndArgs FireBenchmarkCommand(
+		TEXT("CrawlingChaos.FireBenchmark"),
+		TEXT("Fire every weapon type from scripted shooters and write a report. Args: [Shooters] [Pickups] [FramesPerWeapon]"),
+		FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+		{
+			UFireBenchmarkSubsystem* Benchmark = World ? World->GetSubsystem<UFireBenchmarkSubsystem>() : nullptr;
+			if (Benchmark == nullptr) return;
+
+			const int32 NumShooters = Args.IsValidIndex(0) ? FCString::Atoi(*Args[0]) : UFireBenchmarkSubsystem::DefaultNumShooters;
+			const int32 NumPickups = Args.IsValidIndex(1) ? FCString::Atoi(*Args[1]) : UFireBenchmarkSubsystem::DefaultNumPickups;
+			const int32 FramesPerWeapon = Args.IsValidIndex(2) ? FCString::Atoi(*Args[2]) : UFireBenchmarkSubsystem::DefaultFramesPerWeapon;
+			Benchmark->StartBenchmark(NumShooters, NumPickups, FramesPerWeapon);
+		}));
+
+	FVector GridLocation(const FVector& Origin, const int32 Index, const int32 Count)
+	{
+		const int32 Columns = FMath::Max(FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Count))), 1);
+		return Origin + FVector(Index / Columns, Index % Columns, 0.f) * GridSpacing;
+	}
+
+	float Percentile(TArray<float> Samples, const float Fraction)
+	{
+		if (Samples.Num() == 0) return 0.f;
+		
+		Samples.Sort();
+		return Samples[FMath::Clamp(FMath::FloorToInt(Fraction * Samples.Num()), 0, Samples.Num() - 1)];
+	}
+}
+
+void UFireBenchmarkSubsystem::Deinitialize()
+{
+	bRunning = false;
+	
+	Super::Deinitialize();
+}
+
+bool UFireBenchmarkSubsystem::IsTickable() const
+{
+	return bRunning;
+}
+
+TStatId UFireBenchmarkSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UFireBenchmarkSubsystem, STATGROUP_Tickables);
+}
+
+void UFireBenchmarkSubsystem::StartBenchmark(const int32 NumShooters, const int32 NumPickups, const int32 FramesPerWeapon)
+{
+	UWorld* World = GetWorld();
+	if (bRunning || World == nullptr) return;
+
+	// Shooters are whatever the game mode spawns players as, so blueprint setup is part of what's measured
+	const AGameModeBase* GameMode = World->GetAuthGameMode();
+	UClass* ShooterClass = GameMode && GameMode->DefaultPawnClass && GameMode->DefaultPawnClass->IsChildOf<ACrawlingChaosCharacter>()
+		? GameMode->DefaultPawnClass.Get()
+		: ACrawlingChaosCharacter::StaticClass();
+
+	const APlayerController* PlayerController = World->GetFirstPlayerController();
+	const FVector Origin = PlayerController && PlayerController->GetPawn() ? PlayerController->GetPawn()->GetActorLocation() : FVector::ZeroVector;
+
+	FActorSpawnParameters SpawnParameters;
+	SpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	for (int32 Index = 0; Index < NumShooters; ++Index)
+	{
+		ACrawlingChaosCharacter* Shooter = World->SpawnActor<ACrawlingChaosCharacter>(ShooterClass,
+			GridLocation(Origin, Index, NumShooters), FRotator::ZeroRotator, SpawnParameters);
+		if (Shooter == nullptr) continue;
+
+		for (int32 TypeIndex = 0; TypeIndex < static_cast<int32>(EWeaponType::EWT_DefaultMAX); ++TypeIndex)
+		{
+			Shooter->AddWeaponToInventory(static_cast<EWeaponType>(TypeIndex));
+		}
+		Shooters.Add(Shooter);
+	}
+
+	for (int32 Index = 0; Index < NumPickups; ++Index)
+	{
+		const FTransform Transform{GridLocation(Origin + PickupGridOffset, Index, NumPickups)};
+		AWeapon* Pickup = World->SpawnActorDeferred<AWeapon>(AWeapon::StaticClass(), Transform, nullptr, nullptr,
+															 ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+		if (Pickup == nullptr) continue;
+
+		Pickup->SetWeaponType(static_cast<EWeaponType>(Index % static_cast<int32>(EWeaponType::EWT_DefaultMAX)));
+		Pickup->FinishSpawning(Transform);
+		Pickups.Add(Pickup);
+	}
+
+	UE_LOG(LogFireBenchmark, Log, TEXT("Starting fire benchmark: %d shooters, %d pickups, %d frames per weapon"),
+		   Shooters.Num(), Pickups.Num(), FramesPerWeapon);
+
+	FramesPerPhase = FMath::Max(FramesPerWeapon, 1);
+	NumPickupsSpawned = Pickups.Num();
+	Phases.Reset();
+	ReportPath.Reset();
+	bReportWritten = false;
+	bRunning = true;
+
+#if CSV_PROFILER
+	FCsvProfiler::Get()->BeginCapture();
+#endif
+	
+	BeginPhase(static_cast<EWeaponType>(0));
+}
+
+// Called once per frame while the benchmark is running
+void UFireBenchmarkSubsystem::Tick(float DeltaTime)
+{
+	SampleFrame();
+
+	if (Phases.Last().GameThreadMs.Num() < FramesPerPhase) return;
+
+	const int32 NextType = static_cast<int32>(Phases.Last().WeaponType) + 1;
+	if (NextType < static_cast<int32>(EWeaponType::EWT_DefaultMAX))
+	{
+		BeginPhase(static_cast<EWeaponType>(NextType));
+	}
+	else
+	{
+		FinishBenchmark();
+	}
+}
+
+void UFireBenchmarkSubsystem::BeginPhase(const EWeaponType WeaponType)
+{
+	FFireBenchmarkPhase& Phase = Phases.AddDefaulted_GetRef();
+	Phase.WeaponType = WeaponType;
+	Phase.GameThreadMs.Reserve(FramesPerPhase);
+
+	for (ACrawlingChaosCharacter* Shooter : Shooters)
+	{
+		if (!IsValid(Shooter)) continue;
+
+		if (AWeapon* Weapon = Shooter->GetWeaponActor())
+		{
+			Weapon->ReleaseTrigger();
+		}
+		Shooter->SwapWeapons(WeaponType);
+	}
+	
+	LastRoundsFired = CountRoundsFired();
+	LastTracesIssued = GCrawlingChaosTracesIssued;
+	CSV_EVENT(CrawlingChaos, TEXT("FireBenchmark %s"), *UEnum::GetValueAsString(WeaponType));
+}
+
+void UFireBenchmarkSubsystem::SampleFrame()
+{
+	FFireBenchmarkPhase& Phase = Phases.Last();
+	const FWeaponDataTable* Definition = UWeaponDefinitionSubsystem::FindDefinition(Phase.WeaponType);
+
+	// Burst weapons fire one pellet per round
+	const int64 RoundsFired = CountRoundsFired();
+	const int64 FrameRounds = RoundsFired - LastRoundsFired;
+	const int64 PelletsPerRound = Definition->FireMode == EFireMode::EFM_Burst ? 1 : FMath::Max(Definition->NumberOfShots, 1);
+	LastRoundsFired = RoundsFired;
+
+	const int64 FrameTraces = static_cast<int64>(GCrawlingChaosTracesIssued - LastTracesIssued);
+	LastTracesIssued = GCrawlingChaosTracesIssued;
+
+	const float GameThreadMs = FPlatformTime::ToMilliseconds(GGameThreadTime);
+	const int32 ActorCount = GetWorld()->GetActorCount();
+	const int32 LiveMIDs = CountLiveMIDs(GetWorld());
+	const uint64 UsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+	
+	Phase.GameThreadMs.Add(GameThreadMs);
+	Phase.RoundsFired += FrameRounds;
+	Phase.PelletsFired += FrameRounds * PelletsPerRound;
+	Phase.TracesIssued += FrameTraces;
+	Phase.PeakActorCount = FMath::Max(Phase.PeakActorCount, ActorCount);
+	Phase.PeakLiveMIDs = FMath::Max(Phase.PeakLiveMIDs, LiveMIDs);
+	Phase.PeakUsedPhysical = FMath::Max(Phase.PeakUsedPhysical, UsedPhysical);
+
+	CSV_CUSTOM_STAT(CrawlingChaos, BenchmarkGameThreadMs, GameThreadMs, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(CrawlingChaos, BenchmarkRounds, static_cast<int32>(FrameRounds), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(CrawlingChaos, BenchmarkPellets, static_cast<int32>(FrameRounds * PelletsPerRound), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(CrawlingChaos, TracesIssued, static_cast<int32>(FrameTraces), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(CrawlingChaos, BenchmarkActors, ActorCount, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(CrawlingChaos, BenchmarkUsedPhysicalMB, static_cast<float>(UsedPhysical / (1024.0 * 1024.0)), ECsvCustomStatOp::Set);
+
+	// Keep everyone topped up and the trigger held; semi-auto pulls are gated by the rate of fire anyway
+	for (ACrawlingChaosCharacter* Shooter : Shooters)
+	{
+		AWeapon* Weapon = IsValid(Shooter) ? Shooter->GetWeaponActor() : nullptr;
+		if (Weapon == nullptr) continue;
+
+		Shooter->GetInventory()->SetAmmo(Definition->AmmoType, BenchmarkAmmo);
+		Weapon->PullTrigger();
+		if (Definition->FireMode != EFireMode::EFM_FullAuto)
+		{
+			Weapon->ReleaseTrigger();
+		}
+	}
+}
+
+void UFireBenchmarkSubsystem::FinishBenchmark()
+{
+	bRunning = false;
+
+#if CSV_PROFILER
+	FCsvProfiler::Get()->EndCapture();
+#endif
+
+	for (ACrawlingChaosCharacter* Shooter : Shooters)
+	{
+		if (IsValid(Shooter))
+		{
+			if (AWeapon* Weapon = Shooter->GetWeaponActor())
+			{
+				Weapon->Destroy();
+			}
+			Shooter->Destroy();
+		}
+	}
+	for (AWeapon* Pickup : Pickups)
+	{
+		if (IsValid(Pickup))
+		{
+			Pickup->Destroy();
+		}
+	}
+	
+	bReportWritten = WriteReport();
+	Shooters.Reset();
+	Pickups.Reset();
+
+	if (FParse::Param(FCommandLine::Get(), TEXT("FireBenchmarkExit")))
+	{
+		FPlatformMisc::RequestExit(false);
+	}
+}
+
+bool UFireBenchmarkSubsystem::WriteReport()
+{
+	const TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("Map"), GetWorld()->GetMapName());
+	Report->SetStringField(TEXT("BuildVersion"), FApp::GetBuildVersion());
+	Report->SetStringField(TEXT("Configuration"), LexToString(FApp::GetBuildConfiguration()));
+	Report->SetNumberField(TEXT("Shooters"), Shooters.Num());
+	Report->SetNumberField(TEXT("Pickups"), NumPickupsSpawned);
+	Report->SetNumberField(TEXT("FramesPerWeapon"), FramesPerPhase);
+
+	TArray<TSharedPtr<FJsonValue>> PhaseValues;
+	for (const FFireBenchmarkPhase& Phase : Phases)
+	{
+		const FWeaponDataTable* Definition = UWeaponDefinitionSubsystem::FindDefinition(Phase.WeaponType);
+		const float TotalMs = Algo::Accumulate(Phase.GameThreadMs, 0.f);
+		
+		const TSharedRef<FJsonObject> PhaseObject = MakeShared<FJsonObject>();
+		PhaseObject->SetStringField(TEXT("WeaponType"), UEnum::GetValueAsString(Phase.WeaponType));
+		PhaseObject->SetStringField(TEXT("FireMode"), UEnum::GetValueAsString(Definition->FireMode));
+		PhaseObject->SetNumberField(TEXT("Frames"), Phase.GameThreadMs.Num());
+		PhaseObject->SetNumberField(TEXT("GameThreadMsAvg"), Phase.GameThreadMs.Num() > 0 ? TotalMs / Phase.GameThreadMs.Num() : 0.f);
+		PhaseObject->SetNumberField(TEXT("GameThreadMsP95"), Percentile(Phase.GameThreadMs, 0.95f));
+		PhaseObject->SetNumberField(TEXT("GameThreadMsMax"), Percentile(Phase.GameThreadMs, 1.f));
+		PhaseObject->SetNumberField(TEXT("RoundsFired"), Phase.RoundsFired);
+		PhaseObject->SetNumberField(TEXT("PelletsFired"), Phase.PelletsFired);
+		PhaseObject->SetNumberField(TEXT("TracesIssued"), Phase.TracesIssued);
+		PhaseObject->SetNumberField(TEXT("PeakActorCount"), Phase.PeakActorCount);
+		PhaseObject->SetNumberField(TEXT("PeakLiveMIDs"), Phase.PeakLiveMIDs);
+		PhaseObject->SetNumberField(TEXT("PeakUsedPhysicalMB"), Phase.PeakUsedPhysical / (1024.0 * 1024.0));
+		PhaseValues.Add(MakeShared<FJsonValueObject>(PhaseObject));
+	}
+	Report->SetArrayField(TEXT("Phases"), PhaseValues);
+
+	FString Json;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+
+	ReportPath = FPaths::Combine(FPaths::ProfilingDir(), TEXT("FireBenchmark"),
+		FString::Printf(TEXT("FireBenchmark-%s.json"), *FDateTime::Now().ToString()));
+	if (!FFileHelper::SaveStringToFile(Json, *ReportPath))
+	{
+		UE_LOG(LogFireBenchmark, Error, TEXT("Couldn't write the fire benchmark report to %s"), *ReportPath);
+		return false;
+	}
+	
+	UE_LOG(LogFireBenchmark, Log, TEXT("Fire benchmark report written to %s"), *ReportPath);
+	return true;
+}
+
+int64 UFireBenchmarkSubsystem::CountRoundsFired() const
+{
+	if (Phases.Num() == 0) return 0;
+
+	int64 RoundsFired = 0;
+	for (const ACrawlingChaosCharacter* Shooter : Shooters)
+	{
+		const UWeaponInstance* Weapon = IsValid(Shooter) ? Shooter->GetInventory()->GetWeapon(Phases.Last().WeaponType) : nullptr;
+		RoundsFired += Weapon ? Weapon->GetShotIndex() : 0;
+	}
+	return RoundsFired;
+}
@@ -0,0 +1,99 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "FireBenchmarkSubsystem.h"
+
+#include "../CrawlingChaos.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/PackageName.h"
+#include "Tests/AutomationCommon.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** Longest a benchmark may take before the run is failed rather than left hanging */
+	constexpr double BenchmarkTimeoutSeconds{600.0};
+
+	UFireBenchmarkSubsystem* GetBenchmark()
+	{
+		const UWorld* World = AutomationCommon::GetAnyGameWorld();
+		return World ? World->GetSubsystem<UFireBenchmarkSubsystem>() : nullptr;
+	}
+}
+
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FStartFireBenchmarkCommand, FAutomationTestBase*, Test);
+
+bool FStartFireBenchmarkCommand::Update()
+{
+	UFireBenchmarkSubsystem* Benchmark = GetBenchmark();
+	if (Benchmark == nullptr)
+	{
+		Test->AddError(TEXT("No game world with a fire benchmark to run"));
+		return true;
+	}
+
+	Benchmark->StartBenchmark(UFireBenchmarkSubsystem::DefaultNumShooters, UFireBenchmarkSubsystem::DefaultNumPickups,
+							  UFireBenchmarkSubsystem::DefaultFramesPerWeapon);
+	if (!Benchmark->IsRunning())
+	{
+		Test->AddError(TEXT("The fire benchmark didn't start"));
+	}
+	return true;
+}
+
+DEFINE_LATENT_AUTOMATION_COMMAND_ONE_PARAMETER(FWaitForFireBenchmarkCommand, FAutomationTestBase*, Test);
+
+bool FWaitForFireBenchmarkCommand::Update()
+{
+	const UFireBenchmarkSubsystem* Benchmark = GetBenchmark();
+	if (Benchmark == nullptr)
+	{
+		Test->AddError(TEXT("The fire benchmark's world went away before it finished"));
+		return true;
+	}
+
+	if (Benchmark->IsRunning())
+	{
+		if (GetCurrentRunTime() < BenchmarkTimeoutSeconds) return false;
+
+		Test->AddError(FString::Printf(TEXT("The fire benchmark didn't finish within %.0f seconds"), BenchmarkTimeoutSeconds));
+		return true;
+	}
+
+	if (!Benchmark->WasReportWritten())
+	{
+		Test->AddError(FString::Printf(TEXT("Couldn't write the fire benchmark report to %s"), *Benchmark->GetReportPath()));
+	}
+	return true;
+}
+
+/** Runs the fire benchmark on each of the configured benchmark maps */
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FFireBenchmarkTest, "CrawlingChaos.Performance.FireBenchmark",
+								  EAutomationTestFlags::ClientContext | EAutomationTestFlags::PerfFilter)
+
+void FFireBenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (const FString& Map : GetDefault<UFireBenchmarkSubsystem>()->BenchmarkMaps)
+	{
+		OutBeautifiedNames.Add(FPackageName::GetShortName(Map));
+		OutTestCommands.Add(Map);
+	}
+}
+
+bool FFireBenchmarkTest::RunTest(const FString& Parameters)
+{
+	if (!AutomationOpenMap(Parameters))
+	{
+		AddError(FString::Printf(TEXT("Couldn't open benchmark map %s"), *Parameters));
+		return false;
+	}
+
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForMapToLoadCommand());
+	ADD_LATENT_AUTOMATION_COMMAND(FStartFireBenchmarkCommand(this));
+	ADD_LATENT_AUTOMATION_COMMAND(FWaitForFireBenchmarkCommand(this));
+	return true;
+}
+
+#endif
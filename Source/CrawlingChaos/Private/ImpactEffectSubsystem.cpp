@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ImpactEffectSubsystem.h"
+
+#include "../CrawlingChaos.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "NiagaraComponent.h"
+#include "NiagaraSystem.h"
+
+namespace
+{
+	/** User parameter telling the impact system how many hits it stands for */
+	const FName ImpactCountParameter{TEXT("ImpactCount")};
+}
+
+UImpactEffectSubsystem::UImpactEffectSubsystem() :
+	MergeDistance(30.f),
+	SpawnBudgetPerFrame(8),
+	MaxComponentsPerSystem(32),
+	NumDroppedImpacts(0)
+{
+}
+
+void UImpactEffectSubsystem::Deinitialize()
+{
+	// Playing components belong to the pool as much as idle ones; none of them should outlive it on the world settings
+	for (TPair<UNiagaraSystem*, FImpactEffectPool>& Pair : Pools)
+	{
+		for (TArray<UNiagaraComponent*>* Components : {&Pair.Value.Free, &Pair.Value.Active})
+		{
+			for (UNiagaraComponent* Component : *Components)
+			{
+				if (IsValid(Component))
+				{
+					Component->OnSystemFinished.RemoveAll(this);
+					Component->DestroyComponent();
+				}
+			}
+		}
+	}
+	Pools.Reset();
+	PendingBursts.Reset();
+	
+	Super::Deinitialize();
+}
+
+bool UImpactEffectSubsystem::IsTickable() const
+{
+	return PendingBursts.Num() > 0;
+}
+
+TStatId UImpactEffectSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UImpactEffectSubsystem, STATGROUP_Tickables);
+}
+
+void UImpactEffectSubsystem::QueueImpact(UNiagaraSystem* System, const FVector& Location, const FVector& Normal)
+{
+	if (System == nullptr) return;
+
+	// Fold it into a burst of the same system that landed nearby this frame
+	const float MergeDistanceSquared = FMath::Square(MergeDistance);
+	for (FImpactBurst& Burst : PendingBursts)
+	{
+		if (Burst.System == System && FVector::DistSquared(Burst.Location, Location) <= MergeDistanceSquared)
+		{
+			// Running average keeps the burst centred on everything it stands for
+			++Burst.Count;
+			Burst.Location += (Location - Burst.Location) / Burst.Count;
+			return;
+		}
+	}
+
+	FImpactBurst& Burst = PendingBursts.AddDefaulted_GetRef();
+	Burst.System = System;
+	Burst.Location = Location;
+	Burst.Normal = Normal;
+	Burst.Count = 1;
+}
+
+void UImpactEffectSubsystem::Prewarm(UNiagaraSystem* System, const int32 Count)
+{
+	if (System == nullptr) return;
+
+	FImpactEffectPool& Pool = Pools.FindOrAdd(System);
+	const int32 Target = FMath::Min(Count, MaxComponentsPerSystem);
+	while (Pool.Free.Num() + Pool.Active.Num() < Target)
+	{
+		UNiagaraComponent* Component = CreateComponent(System);
+		if (Component == nullptr) break;
+		
+		Pool.Free.Add(Component);
+	}
+}
+
+void UImpactEffectSubsystem::Tick(float DeltaTime)
+{
+	int32 NumSpawned = 0;
+	for (const FImpactBurst& Burst : PendingBursts)
+	{
+		UNiagaraComponent* Component = NumSpawned < SpawnBudgetPerFrame ? AcquireComponent(Burst.System) : nullptr;
+		if (Component == nullptr)
+		{
+			NumDroppedImpacts += Burst.Count;
+			continue;
+		}
+
+		Component->SetWorldLocationAndRotation(Burst.Location, Burst.Normal.Rotation());
+		Component->SetVariableInt(ImpactCountParameter, Burst.Count);
+		Component->Activate(true);
+		++NumSpawned;
+		INC_DWORD_STAT(STAT_EffectsSpawned);
+	}
+	PendingBursts.Reset();
+}
+
+UNiagaraComponent* UImpactEffectSubsystem::AcquireComponent(UNiagaraSystem* System)
+{
+	FImpactEffectPool& Pool = Pools.FindOrAdd(System);
+
+	UNiagaraComponent* Component = nullptr;
+	while (Component == nullptr && Pool.Free.Num() > 0)
+	{
+		UNiagaraComponent* Candidate = Pool.Free.Pop(false);
+		if (IsValid(Candidate))
+		{
+			Component = Candidate;
+		}
+	}
+
+	if (Component == nullptr && Pool.Active.Num() < MaxComponentsPerSystem)
+	{
+		Component = CreateComponent(System);
+	}
+
+	if (Component)
+	{
+		Pool.Active.Add(Component);
+	}
+	return Component;
+}
+
+UNiagaraComponent* UImpactEffectSubsystem::CreateComponent(UNiagaraSystem* System)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr) return nullptr;
+
+	UObject* Outer = World->GetWorldSettings() ? static_cast<UObject*>(World->GetWorldSettings()) : World;
+	UNiagaraComponent* Component = NewObject<UNiagaraComponent>(Outer);
+	Component->SetAutoActivate(false);
+	Component->SetAutoDestroy(false);
+	Component->SetAsset(System);
+	Component->SetUsingAbsoluteLocation(true);
+	Component->SetUsingAbsoluteRotation(true);
+	Component->OnSystemFinished.AddUniqueDynamic(this, &UImpactEffectSubsystem::OnImpactEffectFinished);
+	Component->RegisterComponentWithWorld(World);
+	return Component;
+}
+
+void UImpactEffectSubsystem::OnImpactEffectFinished(UNiagaraComponent* FinishedComponent)
+{
+	if (!IsValid(FinishedComponent)) return;
+	
+	if (FImpactEffectPool* Pool = Pools.Find(FinishedComponent->GetAsset()))
+	{
+		if (Pool->Active.RemoveSingleSwap(FinishedComponent, false) > 0)
+		{
+			Pool->Free.Add(FinishedComponent);
+		}
+	}
+}
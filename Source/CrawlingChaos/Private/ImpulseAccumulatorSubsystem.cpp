@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ImpulseAccumulatorSubsystem.h"
+
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "Physics/PhysicsInterfaceCore.h"
+#include "PhysicsEngine/BodyInstance.h"
+
+void UImpulseAccumulatorSubsystem::Deinitialize()
+{
+	PendingImpulses.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UImpulseAccumulatorSubsystem::IsTickable() const
+{
+	return PendingImpulses.Num() > 0;
+}
+
+TStatId UImpulseAccumulatorSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UImpulseAccumulatorSubsystem, STATGROUP_Tickables);
+}
+
+bool UImpulseAccumulatorSubsystem::AddImpulseAtLocation(UPrimitiveComponent* Component, const FName BoneName,
+														const FVector& Impulse, const FVector& Location)
+{
+	// Anything can be hit, but only simulating bodies can be pushed
+	if (!IsValid(Component) || !Component->IsSimulatingPhysics(BoneName)) return false;
+
+	const float Size = Impulse.Size();
+	if (Size <= KINDA_SMALL_NUMBER) return false;
+
+	FPendingImpulse* Pending = PendingImpulses.FindByPredicate([Component, BoneName](const FPendingImpulse& Entry)
+	{
+		return Entry.Component.Get() == Component && Entry.BoneName == BoneName;
+	});
+	if (Pending == nullptr)
+	{
+		Pending = &PendingImpulses.AddDefaulted_GetRef();
+		Pending->Component = Component;
+		Pending->BoneName = BoneName;
+	}
+
+	// Summed impulses pushed through their weighted centre keep the total push and roughly the same spin
+	Pending->Impulse += Impulse;
+	Pending->Weight += Size;
+	Pending->Location += (Location - Pending->Location) * (Size / Pending->Weight);
+	return true;
+}
+
+// Called once per frame while impulses are pending
+void UImpulseAccumulatorSubsystem::Tick(float DeltaTime)
+{
+	FPhysScene* PhysScene = GetWorld()->GetPhysicsScene();
+	if (PhysScene == nullptr)
+	{
+		PendingImpulses.Reset();
+		return;
+	}
+
+	// Things might have stopped simulating or been destroyed since they were hit
+	TArray<TPair<FBodyInstance*, const FPendingImpulse*>, TInlineAllocator<32>> Bodies;
+	for (const FPendingImpulse& Pending : PendingImpulses)
+	{
+		UPrimitiveComponent* Component = Pending.Component.Get();
+		if (!IsValid(Component)) continue;
+
+		FBodyInstance* BodyInstance = Component->GetBodyInstance(Pending.BoneName);
+		if (BodyInstance && BodyInstance->IsValidBodyInstance() && BodyInstance->IsInstanceSimulatingPhysics())
+		{
+			Bodies.Emplace(BodyInstance, &Pending);
+		}
+	}
+
+	// One lock on the scene for every body instead of one per pellet
+	if (Bodies.Num() > 0)
+	{
+		FPhysicsCommand::ExecuteWrite(PhysScene, [&Bodies]()
+		{
+			for (const TPair<FBodyInstance*, const FPendingImpulse*>& Body : Bodies)
+			{
+				FPhysicsInterface::AddImpulseAtLocation_AssumesLocked(Body.Key->GetPhysicsActorHandle(),
+																	  Body.Value->Impulse, Body.Value->Location);
+			}
+		});
+	}
+
+	PendingImpulses.Reset();
+}
@@ -0,0 +1,75 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "InventoryComponent.h"
+
+#include "WeaponAssetSubsystem.h"
+#include "WeaponInstance.h"
+
+UInventoryComponent::UInventoryComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	Ammo.SetNumZeroed(static_cast<int32>(EAmmoType::EAT_MAX));
+	Weapons.SetNumZeroed(static_cast<int32>(EWeaponType::EWT_DefaultMAX));
+}
+
+void UInventoryComponent::SetAmmo(const EAmmoType AmmoType, const int32 Amount)
+{
+	int32& Current = Ammo[AmmoIndex(AmmoType)];
+	const int32 NewAmount = FMath::Max(Amount, 0);
+	if (Current == NewAmount) return;
+	
+	Current = NewAmount;
+	OnAmmoChanged.Broadcast(AmmoType, Current);
+}
+
+void UInventoryComponent::AddAmmo(const EAmmoType AmmoType, const int32 Amount)
+{
+	SetAmmo(AmmoType, Ammo[AmmoIndex(AmmoType)] + Amount);
+}
+
+int32 UInventoryComponent::ConsumeAmmo(const EAmmoType AmmoType, const int32 Amount)
+{
+	int32& Current = Ammo[AmmoIndex(AmmoType)];
+	const int32 Consumed = FMath::Clamp(Amount, 0, Current);
+	if (Consumed == 0) return 0;
+	
+	Current -= Consumed;
+	OnAmmoChanged.Broadcast(AmmoType, Current);
+	return Consumed;
+}
+
+UWeaponInstance* UInventoryComponent::AddWeapon(const EWeaponType WeaponType)
+{
+	UWeaponInstance*& Slot = Weapons[WeaponIndex(WeaponType)];
+	if (Slot != nullptr) return nullptr;
+
+	Slot = NewObject<UWeaponInstance>(this);
+	Slot->Initialize(WeaponType);
+
+	// Carried weapons keep their assets resident so swapping to one never waits on a load
+	if (UWeaponAssetSubsystem* WeaponAssets = GetWorld()->GetSubsystem<UWeaponAssetSubsystem>())
+	{
+		WeaponAssets->PinWeapon(WeaponType);
+	}
+	
+	OnWeaponAdded.Broadcast(Slot);
+	return Slot;
+}
+
+void UInventoryComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWeaponAssetSubsystem* WeaponAssets = GetWorld()->GetSubsystem<UWeaponAssetSubsystem>())
+	{
+		for (const UWeaponInstance* Weapon : Weapons)
+		{
+			if (Weapon)
+			{
+				WeaponAssets->UnpinWeapon(Weapon->GetWeaponType());
+			}
+		}
+	}
+	
+	Super::EndPlay(EndPlayReason);
+}
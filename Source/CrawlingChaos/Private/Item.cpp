@@ -4,24 +4,42 @@
 #include "Item.h"
 
 
+#include "ItemOscillationSubsystem.h"
+#include "PickupRenderSubsystem.h"
+#include "PickupSubsystem.h"
 #include "Components/SphereComponent.h"
+#include "Materials/MaterialInstanceDynamic.h"
 
 // Sets default values
 AItem::AItem() :
 		OscCurveLength(2.f),
-		bCanOscillate(true)
+		bCanOscillate(true),
+		bOscillationRegistered(false),
+		bCanBePickedUp(false),
+		bPickupRegistered(false),
+		bWantsPickupInstance(false),
+		bPickupInstanced(false),
+		bItemMeshShown(false),
+		AppliedComponentState(),
+		bComponentStateApplied(false)
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	// Items never tick; the oscillation subsystem bobs every pickup in one pass
+	PrimaryActorTick.bCanEverTick = false;
 
-	ItemMesh = CreateDefaultSubobject<USkeletalMeshComponent>(TEXT("ItemMesh"));
-	SetRootComponent(ItemMesh);
+	ItemRoot = CreateDefaultSubobject<USceneComponent>(TEXT("ItemRoot"));
+	SetRootComponent(ItemRoot);
+
+	// Pickups are drawn through the pickup render subsystem; the skeletal mesh waits until something needs it
+	ItemMesh = nullptr;
+	MaterialData.Init(0.f, ItemMaterialData::Num);
 	
 	AreaSphere = CreateDefaultSubobject<USphereComponent>(TEXT("AreaSphere"));
-	AreaSphere->SetupAttachment(ItemMesh);
+	AreaSphere->SetupAttachment(ItemRoot);
 	AreaSphere->SetRelativeLocation(FVector{0,0,0});
 	AreaSphere->SetHiddenInGame(true);
 	AreaSphere->SetVisibility(false);
+	AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	AreaSphere->SetGenerateOverlapEvents(false);
 }
 
 // Called when the game starts or when spawned
@@ -30,44 +48,239 @@ void AItem::BeginPlay()
 	Super::BeginPlay();
 	
 	InitialLocation = FVector{ GetActorLocation() };
+	UpdateOscillationRegistration();
+	UpdatePickupRegistration();
+	UpdatePickupInstance();
+}
 
+// Called when the actor is spawned, moved, or a property is changed
+void AItem::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	// Nothing draws pickup instances outside of play, so show the real mesh for placing the item
+	const UWorld* World = GetWorld();
+	if (World && !World->IsGameWorld())
+	{
+		CreateItemMesh();
+	}
+}
+
+void AItem::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	bCanOscillate = false;
+	UpdateOscillationRegistration();
+	bCanBePickedUp = false;
+	UpdatePickupRegistration();
+	bWantsPickupInstance = false;
+	UpdatePickupInstance();
+	
+	Super::EndPlay(EndPlayReason);
+}
+
+void AItem::SetCanOscillate(const bool bShouldOscillate)
+{
+	if (bCanOscillate == bShouldOscillate) return;
+	
+	bCanOscillate = bShouldOscillate;
 	if (bCanOscillate)
 	{
-		GetWorldTimerManager().SetTimer(OscTimer, this, &AItem::OscillateCallback, OscCurveLength);	
+		// Bob around wherever we've ended up
+		InitialLocation = GetActorLocation();
 	}
+	UpdateOscillationRegistration();
 }
 
-void AItem::OscillateInPlace()
+void AItem::UpdateOscillationRegistration()
 {
-	if (OscCurve)
+	// Nothing to do until we're in play
+	if (!HasActorBegunPlay() && !IsActorBeginningPlay()) return;
+
+	const bool bShouldBeRegistered = bCanOscillate && OscCurve != nullptr;
+	if (bShouldBeRegistered == bOscillationRegistered) return;
+
+	UWorld* World = GetWorld();
+	UItemOscillationSubsystem* Oscillation = World ? World->GetSubsystem<UItemOscillationSubsystem>() : nullptr;
+	if (Oscillation == nullptr) return;
+
+	if (bShouldBeRegistered)
+	{
+		Oscillation->Register(this, InitialLocation);
+	}
+	else
 	{
-		const FVector Height = FVector{ InitialLocation.X, InitialLocation.Y, InitialLocation.Z +
-			50*OscCurve->GetFloatValue(GetWorldTimerManager().GetTimerElapsed(OscTimer))};
-		this->SetActorLocation(Height);
+		Oscillation->Unregister(this);
 	}
+	bOscillationRegistered = bShouldBeRegistered;
 }
 
-void AItem::OscillateCallback()
+void AItem::UpdatePickupRegistration()
 {
-	if (bCanOscillate)
+	// Nothing to do until we're in play
+	if (!HasActorBegunPlay() && !IsActorBeginningPlay()) return;
+	if (bCanBePickedUp == bPickupRegistered) return;
+
+	UWorld* World = GetWorld();
+	UPickupSubsystem* Pickups = World ? World->GetSubsystem<UPickupSubsystem>() : nullptr;
+	if (Pickups == nullptr) return;
+
+	if (bCanBePickedUp)
+	{
+		Pickups->RegisterPickup(this, AreaSphere->GetScaledSphereRadius());
+	}
+	else
 	{
-		GetWorldTimerManager().SetTimer(OscTimer, this, &AItem::OscillateCallback, OscCurveLength);
+		Pickups->UnregisterPickup(this);
 	}
+	bPickupRegistered = bCanBePickedUp;
 }
 
-// Called every frame
-void AItem::Tick(float DeltaTime)
+void AItem::UpdatePickupInstance()
 {
-	Super::Tick(DeltaTime);
+	// Nothing to do until we're in play
+	if (!HasActorBegunPlay() && !IsActorBeginningPlay()) return;
 
-	if (bCanOscillate)
+	// Nothing to draw until the streamer has the mesh; whoever loads it calls back in here
+	UStaticMesh* Mesh = bWantsPickupInstance ? PickupStaticMesh.Get() : nullptr;
+	const bool bShouldBeInstanced = Mesh != nullptr;
+	if (bShouldBeInstanced == bPickupInstanced) return;
+
+	UWorld* World = GetWorld();
+	UPickupRenderSubsystem* PickupRender = World ? World->GetSubsystem<UPickupRenderSubsystem>() : nullptr;
+	if (PickupRender == nullptr) return;
+
+	if (bShouldBeInstanced)
+	{
+		bPickupInstanced = PickupRender->AddPickup(this, Mesh, ItemRoot->GetComponentTransform(), MaterialData);
+	}
+	else
 	{
-		OscillateInPlace();	
+		PickupRender->RemovePickup(this);
+		bPickupInstanced = false;
 	}
 }
 
-void AItem::Equip()
+USkeletalMeshComponent* AItem::CreateItemMesh()
 {
-	bCanOscillate = false;
+	if (ItemMesh != nullptr) return ItemMesh;
+
+	ItemMesh = NewObject<USkeletalMeshComponent>(this, TEXT("ItemMesh"), RF_Transient);
+	ItemMesh->SetupAttachment(ItemRoot);
+	for (int32 DataIndex = 0; DataIndex < MaterialData.Num(); ++DataIndex)
+	{
+		ItemMesh->SetCustomPrimitiveDataFloat(DataIndex, MaterialData[DataIndex]);
+	}
+	// Anything created before the actor's components are registered gets registered along with them
+	if (ItemRoot->IsRegistered())
+	{
+		ItemMesh->RegisterComponent();
+	}
+	OnItemMeshCreated();
+	return ItemMesh;
+}
+
+void AItem::SetMaterialData(const int32 DataIndex, const float Value)
+{
+	check(MaterialData.IsValidIndex(DataIndex));
+	if (MaterialData[DataIndex] == Value) return;
+
+	MaterialData[DataIndex] = Value;
+	if (ItemMesh != nullptr)
+	{
+		ItemMesh->SetCustomPrimitiveDataFloat(DataIndex, Value);
+	}
+	if (bPickupInstanced)
+	{
+		if (UPickupRenderSubsystem* PickupRender = GetWorld()->GetSubsystem<UPickupRenderSubsystem>())
+		{
+			PickupRender->SetPickupMaterialData(this, MaterialData);
+		}
+	}
+}
+
+void AItem::SetMaterialData(const int32 DataIndex, const FLinearColor& Color)
+{
+	SetMaterialData(DataIndex, Color.R);
+	SetMaterialData(DataIndex + 1, Color.G);
+	SetMaterialData(DataIndex + 2, Color.B);
+}
+
+UMaterialInstanceDynamic* AItem::GetOrCreateDynamicMaterial(const int32 ElementIndex)
+{
+	if (ItemMesh == nullptr) return nullptr;
+
+	// Hands back the one already there if it's been asked for before
+	return ItemMesh->CreateDynamicMaterialInstance(ElementIndex);
 }
 
+void AItem::ApplyComponentState(const FItemComponentState& TargetState)
+{
+	// Pickups with a static stand-in are drawn by the pickup render subsystem, so their own mesh stays hidden
+	const UWorld* World = GetWorld();
+	const bool bUseInstance = TargetState.bPickup && !PickupStaticMesh.IsNull() && World && World->IsGameWorld();
+	const bool bMeshShown = TargetState.bMeshVisible && !bUseInstance;
+
+	// The mesh only exists once something needs to see it
+	const bool bMeshCreated = ItemMesh == nullptr && bMeshShown;
+	if (bMeshCreated)
+	{
+		CreateItemMesh();
+	}
+
+	if (ItemMesh != nullptr)
+	{
+		// Nothing's been applied to this mesh yet, so we can't trust anything to already be right
+		const bool bApplyAll = !bComponentStateApplied || bMeshCreated;
+		const FItemComponentState& Current = AppliedComponentState;
+
+		// Shadow flags are plain assignments; the render state is dirtied once below for all of it
+		const bool bShadowChanged = bApplyAll || Current.bMeshCastShadow != TargetState.bMeshCastShadow;
+		if (bShadowChanged)
+		{
+			ItemMesh->CastShadow = TargetState.bMeshCastShadow;
+			ItemMesh->bCastDynamicShadow = TargetState.bMeshCastShadow;
+		}
+		if (bApplyAll || bItemMeshShown != bMeshShown)
+		{
+			// Recreates the render state, which picks up the shadow flags as well
+			ItemMesh->SetVisibility(bMeshShown);
+		}
+		else if (bShadowChanged)
+		{
+			ItemMesh->MarkRenderStateDirty();
+		}
+
+		if (bApplyAll || Current.MeshCollisionResponse != TargetState.MeshCollisionResponse)
+		{
+			ItemMesh->SetCollisionResponseToAllChannels(TargetState.MeshCollisionResponse);
+		}
+		if (bApplyAll || Current.MeshCollisionEnabled != TargetState.MeshCollisionEnabled)
+		{
+			ItemMesh->SetCollisionEnabled(TargetState.MeshCollisionEnabled);
+		}
+		if (bApplyAll || Current.bMeshSimulatePhysics != TargetState.bMeshSimulatePhysics)
+		{
+			ItemMesh->SetSimulatePhysics(TargetState.bMeshSimulatePhysics);
+		}
+		if (bApplyAll || Current.bMeshEnableGravity != TargetState.bMeshEnableGravity)
+		{
+			ItemMesh->SetEnableGravity(TargetState.bMeshEnableGravity);
+		}
+	}
+
+	// All already no-ops when nothing changes
+	bWantsPickupInstance = bUseInstance;
+	UpdatePickupInstance();
+	bCanBePickedUp = TargetState.bPickup;
+	UpdatePickupRegistration();
+	SetCanOscillate(TargetState.bOscillate);
+
+	AppliedComponentState = TargetState;
+	bItemMeshShown = bMeshShown;
+	bComponentStateApplied = true;
+}
+
+void AItem::Equip()
+{
+	SetCanOscillate(false);
+}
@@ -0,0 +1,129 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ItemOscillationSubsystem.h"
+
+#include "../CrawlingChaos.h"
+#include "Curves/CurveFloat.h"
+#include "Engine/World.h"
+#include "Item.h"
+#include "PickupRenderSubsystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Item Oscillation"), STAT_ItemOscillation, STATGROUP_CrawlingChaos);
+
+namespace
+{
+	/** How far the curve's value moves an item up and down */
+	constexpr float OscillationHeight{50.f};
+
+	/** Items that start bobbing within this many seconds of each other share a phase */
+	constexpr double OscillationPhaseTolerance{1.0 / 60.0};
+}
+
+bool UItemOscillationSubsystem::IsTickable() const
+{
+	return Groups.Num() > 0;
+}
+
+TStatId UItemOscillationSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UItemOscillationSubsystem, STATGROUP_Tickables);
+}
+
+void UItemOscillationSubsystem::Register(AItem* Item, const FVector& BaseLocation)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr || Item == nullptr || Item->GetOscCurve() == nullptr) return;
+
+	const double Now = World->GetTimeSeconds();
+	const float Period = Item->GetOscCurveLength();
+	FOscillationGroup* Group = Groups.FindByPredicate([Item, Period, Now](const FOscillationGroup& Candidate)
+	{
+		return Candidate.Curve == Item->GetOscCurve() && Candidate.Period == Period &&
+			FMath::Abs(Candidate.StartTime - Now) <= OscillationPhaseTolerance;
+	});
+	if (Group == nullptr)
+	{
+		Group = &Groups.AddDefaulted_GetRef();
+		Group->Curve = Item->GetOscCurve();
+		Group->Period = Period;
+		Group->StartTime = Now;
+	}
+
+	FOscillatingItem& Entry = Group->Items.AddDefaulted_GetRef();
+	Entry.Item = Item;
+	Entry.BaseLocation = BaseLocation;
+}
+
+void UItemOscillationSubsystem::Unregister(AItem* Item)
+{
+	for (int32 GroupIndex = 0; GroupIndex < Groups.Num(); ++GroupIndex)
+	{
+		TArray<FOscillatingItem>& Items = Groups[GroupIndex].Items;
+		const int32 ItemIndex = Items.IndexOfByPredicate([Item](const FOscillatingItem& Entry)
+		{
+			return Entry.Item == Item;
+		});
+		if (ItemIndex == INDEX_NONE) continue;
+
+		Items.RemoveAtSwap(ItemIndex, 1, false);
+		if (Items.Num() == 0)
+		{
+			Groups.RemoveAtSwap(GroupIndex, 1, false);
+		}
+		return;
+	}
+}
+
+int32 UItemOscillationSubsystem::GetNumItems() const
+{
+	int32 NumItems = 0;
+	for (const FOscillationGroup& Group : Groups)
+	{
+		NumItems += Group.Items.Num();
+	}
+	return NumItems;
+}
+
+void UItemOscillationSubsystem::Tick(float DeltaTime)
+{
+	CRAWLINGCHAOS_SCOPE_CYCLE_COUNTER(STAT_ItemOscillation);
+	SET_DWORD_STAT(STAT_PickupsTicking, GetNumItems());
+	
+	const UWorld* World = GetWorld();
+	if (World == nullptr) return;
+
+#if STATS || CSV_PROFILER
+	// Items are what ask for dynamic material instances, so the world's count is kept while they're around
+	const int32 NumLiveMIDs = CountLiveMIDs(World);
+	SET_DWORD_STAT(STAT_LiveMIDs, NumLiveMIDs);
+	CSV_CUSTOM_STAT(CrawlingChaos, LiveMIDs, NumLiveMIDs, ECsvCustomStatOp::Set);
+#endif
+
+	// Instanced pickups bob through their instance transform; the actor itself stays put
+	UPickupRenderSubsystem* PickupRender = World->GetSubsystem<UPickupRenderSubsystem>();
+	
+	const double Now = World->GetTimeSeconds();
+	for (FOscillationGroup& Group : Groups)
+	{
+		if (Group.Curve == nullptr || Group.Period <= 0.f) continue;
+		
+		// One curve evaluation for the whole group
+		const float Phase = static_cast<float>(FMath::Fmod(Now - Group.StartTime, static_cast<double>(Group.Period)));
+		const FVector Offset{0.f, 0.f, OscillationHeight * Group.Curve->GetFloatValue(Phase)};
+
+		for (const FOscillatingItem& Entry : Group.Items)
+		{
+			if (Entry.Item == nullptr) continue;
+
+			if (PickupRender && Entry.Item->IsPickupInstanced())
+			{
+				PickupRender->SetPickupLocation(Entry.Item, Entry.BaseLocation + Offset);
+			}
+			else if (Entry.Item->GetRootComponent())
+			{
+				Entry.Item->GetRootComponent()->SetWorldLocation(Entry.BaseLocation + Offset);
+			}
+		}
+	}
+}
@@ -0,0 +1,173 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PickupRenderSubsystem.h"
+
+#include "../CrawlingChaos.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Item.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Render Update"), STAT_PickupRenderUpdate, STATGROUP_CrawlingChaos);
+
+void UPickupRenderSubsystem::Deinitialize()
+{
+	if (IsValid(RenderActor))
+	{
+		RenderActor->Destroy();
+	}
+	RenderActor = nullptr;
+	Meshes.Reset();
+	Pickups.Reset();
+
+	Super::Deinitialize();
+}
+
+bool UPickupRenderSubsystem::IsTickable() const
+{
+	return Meshes.ContainsByPredicate([](const FPickupMeshInstances& Mesh)
+	{
+		return Mesh.bInstancesMoved || Mesh.bRenderStateDirty;
+	});
+}
+
+TStatId UPickupRenderSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPickupRenderSubsystem, STATGROUP_Tickables);
+}
+
+int32 UPickupRenderSubsystem::FindOrAddMesh(UStaticMesh* Mesh, const int32 NumMaterialData)
+{
+	const int32 ExistingIndex = Meshes.IndexOfByPredicate([Mesh](const FPickupMeshInstances& Candidate)
+	{
+		return IsValid(Candidate.Instances) && Candidate.Instances->GetStaticMesh() == Mesh;
+	});
+	if (ExistingIndex != INDEX_NONE) return ExistingIndex;
+
+	UWorld* World = GetWorld();
+	if (World == nullptr) return INDEX_NONE;
+
+	if (!IsValid(RenderActor))
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		RenderActor = World->SpawnActor<AActor>(SpawnParams);
+		RenderActor->SetRootComponent(NewObject<USceneComponent>(RenderActor, TEXT("Root")));
+		RenderActor->GetRootComponent()->RegisterComponent();
+	}
+
+	FPickupMeshInstances& Entry = Meshes.AddDefaulted_GetRef();
+	Entry.Instances = NewObject<UInstancedStaticMeshComponent>(RenderActor);
+	Entry.Instances->SetStaticMesh(Mesh);
+	Entry.Instances->SetMobility(EComponentMobility::Movable);
+	Entry.Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Entry.Instances->SetNumCustomDataFloats(NumMaterialData);
+	Entry.Instances->SetupAttachment(RenderActor->GetRootComponent());
+	Entry.Instances->RegisterComponent();
+
+	return Meshes.Num() - 1;
+}
+
+bool UPickupRenderSubsystem::AddPickup(const AItem* Item, UStaticMesh* Mesh, const FTransform& Transform,
+									   const TArray<float>& MaterialData)
+{
+	if (Item == nullptr || Mesh == nullptr) return false;
+	if (Pickups.Contains(Item)) return true;
+
+	const int32 MeshIndex = FindOrAddMesh(Mesh, MaterialData.Num());
+	if (MeshIndex == INDEX_NONE) return false;
+
+	FPickupMeshInstances& Entry = Meshes[MeshIndex];
+	FPickupInstance& Pickup = Pickups.Add(Item);
+	Pickup.MeshIndex = MeshIndex;
+	if (Entry.FreeInstances.Num() > 0)
+	{
+		Pickup.InstanceIndex = Entry.FreeInstances.Pop(false);
+		Entry.Instances->UpdateInstanceTransform(Pickup.InstanceIndex, Transform, true, false, true);
+		Entry.Transforms[Pickup.InstanceIndex] = Transform;
+	}
+	else
+	{
+		Pickup.InstanceIndex = Entry.Instances->AddInstance(Transform, true);
+		check(Pickup.InstanceIndex == Entry.Transforms.Num());
+		Entry.Transforms.Add(Transform);
+	}
+	Entry.Instances->SetCustomData(Pickup.InstanceIndex, MaterialData, false);
+	Entry.bRenderStateDirty = true;
+	return true;
+}
+
+void UPickupRenderSubsystem::RemovePickup(const AItem* Item)
+{
+	FPickupInstance Pickup;
+	if (!Pickups.RemoveAndCopyValue(Item, Pickup)) return;
+
+	FPickupMeshInstances& Entry = Meshes[Pickup.MeshIndex];
+	if (!IsValid(Entry.Instances)) return;
+
+	// Removing would reorder the other instances under their owners; collapse it and keep the slot for the next one
+	FTransform& Collapsed = Entry.Transforms[Pickup.InstanceIndex];
+	Collapsed.SetScale3D(FVector::ZeroVector);
+	Entry.Instances->UpdateInstanceTransform(Pickup.InstanceIndex, Collapsed, true, false, true);
+	Entry.FreeInstances.Add(Pickup.InstanceIndex);
+	Entry.bRenderStateDirty = true;
+}
+
+void UPickupRenderSubsystem::SetPickupLocation(const AItem* Item, const FVector& Location)
+{
+	const FPickupInstance* Pickup = Pickups.Find(Item);
+	if (Pickup == nullptr) return;
+
+	FPickupMeshInstances& Entry = Meshes[Pickup->MeshIndex];
+	Entry.Transforms[Pickup->InstanceIndex].SetLocation(Location);
+	Entry.bInstancesMoved = true;
+}
+
+void UPickupRenderSubsystem::SetPickupMaterialData(const AItem* Item, const TArray<float>& MaterialData)
+{
+	const FPickupInstance* Pickup = Pickups.Find(Item);
+	if (Pickup == nullptr) return;
+
+	FPickupMeshInstances& Entry = Meshes[Pickup->MeshIndex];
+	if (!IsValid(Entry.Instances)) return;
+
+	Entry.Instances->SetCustomData(Pickup->InstanceIndex, MaterialData, false);
+	Entry.bRenderStateDirty = true;
+}
+
+// Called once per frame while instances are waiting to be pushed to the renderer
+void UPickupRenderSubsystem::Tick(float DeltaTime)
+{
+	CRAWLINGCHAOS_SCOPE_CYCLE_COUNTER(STAT_PickupRenderUpdate);
+
+	int32 NumInstancesUpdated = 0;
+	int32 NumRenderStatesDirtied = 0;
+	for (FPickupMeshInstances& Entry : Meshes)
+	{
+		if (IsValid(Entry.Instances))
+		{
+			if (Entry.bInstancesMoved)
+			{
+				// Bobbing moves every pickup, so the whole mesh goes as one batch, which also carries any other
+				// changes this frame to the renderer
+				Entry.Instances->BatchUpdateInstancesTransforms(0, Entry.Transforms, true, true, true);
+				NumInstancesUpdated += Entry.Transforms.Num();
+			}
+			else if (Entry.bRenderStateDirty)
+			{
+				Entry.Instances->MarkRenderStateDirty();
+			}
+			if (Entry.bInstancesMoved || Entry.bRenderStateDirty)
+			{
+				++NumRenderStatesDirtied;
+			}
+		}
+		Entry.bInstancesMoved = false;
+		Entry.bRenderStateDirty = false;
+	}
+
+	INC_DWORD_STAT_BY(STAT_PickupInstancesUpdated, NumInstancesUpdated);
+	CSV_CUSTOM_STAT(CrawlingChaos, PickupInstancesUpdated, NumInstancesUpdated, ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(CrawlingChaos, PickupRenderStatesDirtied, NumRenderStatesDirtied, ECsvCustomStatOp::Set);
+}
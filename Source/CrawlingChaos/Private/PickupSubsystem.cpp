@@ -0,0 +1,159 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PickupSubsystem.h"
+
+#include "../CrawlingChaos.h"
+#include "../CrawlingChaosCharacter.h"
+#include "Item.h"
+#include "Components/CapsuleComponent.h"
+#include "Engine/World.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pickup Query"), STAT_PickupQuery, STATGROUP_CrawlingChaos);
+
+UPickupSubsystem::UPickupSubsystem() :
+	MaxPickupRadius(0.f),
+	CellSize(500.f),
+	QueryInterval(0.1f),
+	TimeSinceQuery(0.f)
+{
+}
+
+void UPickupSubsystem::Deinitialize()
+{
+	Entries.Empty();
+	Cells.Empty();
+	EntryIndices.Empty();
+	Collectors.Empty();
+	
+	Super::Deinitialize();
+}
+
+bool UPickupSubsystem::IsTickable() const
+{
+	return Collectors.Num() > 0 && Entries.Num() > 0;
+}
+
+TStatId UPickupSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UPickupSubsystem, STATGROUP_Tickables);
+}
+
+FIntPoint UPickupSubsystem::GetCell(const FVector& Location) const
+{
+	return FIntPoint(FMath::FloorToInt(Location.X / CellSize), FMath::FloorToInt(Location.Y / CellSize));
+}
+
+void UPickupSubsystem::RegisterPickup(AItem* Item, const float Radius)
+{
+	if (Item == nullptr) return;
+
+	UnregisterPickup(Item);
+
+	FPickupEntry Entry;
+	Entry.Item = Item;
+	Entry.Location = Item->GetActorLocation();
+	Entry.Radius = Radius;
+	Entry.Cell = GetCell(Entry.Location);
+
+	const int32 Index = Entries.Add(Entry);
+	Cells.FindOrAdd(Entry.Cell).Add(Index);
+	EntryIndices.Add(Item, Index);
+	MaxPickupRadius = FMath::Max(MaxPickupRadius, Radius);
+}
+
+void UPickupSubsystem::UnregisterPickup(AItem* Item)
+{
+	int32 Index;
+	if (!EntryIndices.RemoveAndCopyValue(Item, Index)) return;
+
+	const FIntPoint Cell = Entries[Index].Cell;
+	if (TArray<int32, TInlineAllocator<4>>* CellEntries = Cells.Find(Cell))
+	{
+		CellEntries->RemoveSingleSwap(Index, false);
+		if (CellEntries->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+	Entries.RemoveAt(Index);
+}
+
+void UPickupSubsystem::RegisterCollector(ACrawlingChaosCharacter* Collector)
+{
+	if (Collector == nullptr) return;
+	
+	Collectors.AddUnique(Collector);
+}
+
+void UPickupSubsystem::UnregisterCollector(ACrawlingChaosCharacter* Collector)
+{
+	Collectors.RemoveSingleSwap(Collector, false);
+}
+
+void UPickupSubsystem::QueryPickups(const FVector& Location, const float Radius, TArray<AItem*>& OutItems) const
+{
+	CRAWLINGCHAOS_SCOPE_CYCLE_COUNTER(STAT_PickupQuery);
+
+	// Anything further out than this many cells can't reach us
+	const float Reach = Radius + MaxPickupRadius;
+	const FIntPoint MinCell = GetCell(Location - FVector(Reach));
+	const FIntPoint MaxCell = GetCell(Location + FVector(Reach));
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			const TArray<int32, TInlineAllocator<4>>* CellEntries = Cells.Find(FIntPoint(X, Y));
+			if (CellEntries == nullptr) continue;
+
+			for (const int32 Index : *CellEntries)
+			{
+				const FPickupEntry& Entry = Entries[Index];
+				AItem* Item = Entry.Item.Get();
+				if (Item && FVector::DistSquared(Location, Entry.Location) <= FMath::Square(Radius + Entry.Radius))
+				{
+					OutItems.Add(Item);
+				}
+			}
+		}
+	}
+}
+
+// Called once per frame while there are pickups and characters to collect them
+void UPickupSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceQuery += DeltaTime;
+	if (TimeSinceQuery < QueryInterval) return;
+
+	TimeSinceQuery = 0.f;
+
+	// Collecting destroys pickups, which unregisters them, so find everything before handing anything over
+	TArray<TPair<ACrawlingChaosCharacter*, AItem*>, TInlineAllocator<4>> Collected;
+	TArray<AItem*> Candidates;
+	for (int32 Index = Collectors.Num() - 1; Index >= 0; --Index)
+	{
+		ACrawlingChaosCharacter* Collector = Collectors[Index].Get();
+		if (Collector == nullptr)
+		{
+			Collectors.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		// A sphere around the capsule's centre reaching its ends stands in for the capsule the overlaps used
+		Candidates.Reset();
+		QueryPickups(Collector->GetActorLocation(), Collector->GetCapsuleComponent()->GetScaledCapsuleHalfHeight(), Candidates);
+		for (AItem* Item : Candidates)
+		{
+			Collected.Emplace(Collector, Item);
+		}
+	}
+
+	for (const TPair<ACrawlingChaosCharacter*, AItem*>& Pair : Collected)
+	{
+		// An earlier collector may have taken it already
+		if (IsValid(Pair.Value) && EntryIndices.Contains(Pair.Value))
+		{
+			Pair.Value->OnCollected(Pair.Key);
+		}
+	}
+}
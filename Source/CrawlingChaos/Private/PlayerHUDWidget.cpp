@@ -0,0 +1,192 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "PlayerHUDWidget.h"
+
+#include "../CrawlingChaosCharacter.h"
+#include "InventoryComponent.h"
+#include "Weapon.h"
+#include "WeaponInstance.h"
+#include "Blueprint/WidgetTree.h"
+#include "Components/CanvasPanel.h"
+#include "Components/CanvasPanelSlot.h"
+#include "Components/Image.h"
+#include "Components/InvalidationBox.h"
+#include "Components/ProgressBar.h"
+#include "Components/TextBlock.h"
+#include "Engine/Texture2D.h"
+#include "GameFramework/PlayerController.h"
+
+namespace
+{
+	/** Where the crosshair sits relative to the centre of the screen */
+	const FVector2D CrosshairOffset{0.f, 20.f};
+	const FVector2D HealthBarSize{300.f, 24.f};
+	const FVector2D ScreenMargin{40.f, 40.f};
+}
+
+void UPlayerHUDWidget::NativeOnInitialized()
+{
+	Super::NativeOnInitialized();
+
+	BuildDefaultLayout();
+
+	if (APlayerController* PlayerController = GetOwningPlayer())
+	{
+		PlayerController->OnPossessedPawnChanged.AddDynamic(this, &UPlayerHUDWidget::OnPossessedPawnChanged);
+		SetCharacter(Cast<ACrawlingChaosCharacter>(PlayerController->GetPawn()));
+	}
+}
+
+void UPlayerHUDWidget::NativeDestruct()
+{
+	if (APlayerController* PlayerController = GetOwningPlayer())
+	{
+		PlayerController->OnPossessedPawnChanged.RemoveAll(this);
+	}
+	SetCharacter(nullptr);
+	
+	Super::NativeDestruct();
+}
+
+void UPlayerHUDWidget::BuildDefaultLayout()
+{
+	if (WidgetTree->RootWidget == nullptr)
+	{
+		HUDCache = WidgetTree->ConstructWidget<UInvalidationBox>(UInvalidationBox::StaticClass(), TEXT("HUDCache"));
+		WidgetTree->RootWidget = HUDCache;
+	}
+
+	// Missing pieces go on the cache's canvas, or straight on the root if the subclass made that a canvas instead
+	UCanvasPanel* Canvas = nullptr;
+	if (HUDCache != nullptr)
+	{
+		if (HUDCache->GetContent() == nullptr)
+		{
+			HUDCache->SetContent(WidgetTree->ConstructWidget<UCanvasPanel>(UCanvasPanel::StaticClass(), TEXT("HUDCanvas")));
+		}
+		Canvas = Cast<UCanvasPanel>(HUDCache->GetContent());
+	}
+	else
+	{
+		Canvas = Cast<UCanvasPanel>(WidgetTree->RootWidget);
+	}
+	
+	// Nowhere we know how to lay things out; the subclass is on its own
+	if (Canvas == nullptr) return;
+
+	auto AddToCanvas = [Canvas](UWidget* Widget, const FAnchors& Anchors, const FVector2D& Alignment,
+								const FVector2D& Position)
+	{
+		UCanvasPanelSlot* Slot = Canvas->AddChildToCanvas(Widget);
+		Slot->SetAnchors(Anchors);
+		Slot->SetAlignment(Alignment);
+		Slot->SetPosition(Position);
+		Slot->SetAutoSize(true);
+		return Slot;
+	};
+
+	if (Crosshair == nullptr)
+	{
+		Crosshair = WidgetTree->ConstructWidget<UImage>(UImage::StaticClass(), TEXT("Crosshair"));
+		AddToCanvas(Crosshair, FAnchors(0.5f), FVector2D(0.5f), CrosshairOffset);
+	}
+
+	if (AmmoText == nullptr)
+	{
+		AmmoText = WidgetTree->ConstructWidget<UTextBlock>(UTextBlock::StaticClass(), TEXT("AmmoText"));
+		AddToCanvas(AmmoText, FAnchors(1.f), FVector2D(1.f), -ScreenMargin);
+	}
+
+	if (WeaponText == nullptr)
+	{
+		WeaponText = WidgetTree->ConstructWidget<UTextBlock>(UTextBlock::StaticClass(), TEXT("WeaponText"));
+		AddToCanvas(WeaponText, FAnchors(1.f), FVector2D(1.f, 2.f), -ScreenMargin);
+	}
+
+	if (HealthBar == nullptr)
+	{
+		HealthBar = WidgetTree->ConstructWidget<UProgressBar>(UProgressBar::StaticClass(), TEXT("HealthBar"));
+		UCanvasPanelSlot* HealthSlot = AddToCanvas(HealthBar, FAnchors(0.f, 1.f), FVector2D(0.f, 1.f),
+												   FVector2D(ScreenMargin.X, -ScreenMargin.Y));
+		HealthSlot->SetAutoSize(false);
+		HealthSlot->SetSize(HealthBarSize);
+	}
+}
+
+void UPlayerHUDWidget::SetCrosshairTexture(UTexture2D* Texture)
+{
+	if (Crosshair && Texture)
+	{
+		Crosshair->SetBrushFromTexture(Texture, true);
+	}
+}
+
+void UPlayerHUDWidget::SetCharacter(ACrawlingChaosCharacter* NewCharacter)
+{
+	if (Character.Get() == NewCharacter) return;
+
+	if (ACrawlingChaosCharacter* OldCharacter = Character.Get())
+	{
+		OldCharacter->GetInventory()->OnAmmoChanged.RemoveAll(this);
+		OldCharacter->OnEquippedWeaponChanged.RemoveAll(this);
+		OldCharacter->OnHealthChanged.RemoveAll(this);
+	}
+	
+	Character = NewCharacter;
+	if (NewCharacter == nullptr) return;
+
+	NewCharacter->GetInventory()->OnAmmoChanged.AddDynamic(this, &UPlayerHUDWidget::OnAmmoChanged);
+	NewCharacter->OnEquippedWeaponChanged.AddDynamic(this, &UPlayerHUDWidget::OnEquippedWeaponChanged);
+	NewCharacter->OnHealthChanged.AddDynamic(this, &UPlayerHUDWidget::OnHealthChanged);
+
+	// Catch up on everything that happened before we started listening
+	OnEquippedWeaponChanged(NewCharacter->GetEquippedWeapon());
+	OnHealthChanged(NewCharacter->GetHealth(), NewCharacter->GetMaxHealth());
+}
+
+void UPlayerHUDWidget::OnPossessedPawnChanged(APawn* OldPawn, APawn* NewPawn)
+{
+	SetCharacter(Cast<ACrawlingChaosCharacter>(NewPawn));
+}
+
+void UPlayerHUDWidget::OnAmmoChanged(const EAmmoType AmmoType, int32 NewAmount)
+{
+	if (bHasAmmoType && AmmoType == DisplayedAmmoType)
+	{
+		RefreshAmmo();
+	}
+}
+
+void UPlayerHUDWidget::OnEquippedWeaponChanged(UWeaponInstance* Weapon)
+{
+	bHasAmmoType = Weapon != nullptr;
+	if (bHasAmmoType)
+	{
+		DisplayedAmmoType = Weapon->GetDefinition()->AmmoType;
+	}
+	
+	if (WeaponText)
+	{
+		WeaponText->SetText(Weapon ? FText::FromString(Weapon->GetDefinition()->ItemName) : FText::GetEmpty());
+	}
+	RefreshAmmo();
+}
+
+void UPlayerHUDWidget::OnHealthChanged(const float Health, const float MaxHealth)
+{
+	if (HealthBar)
+	{
+		HealthBar->SetPercent(MaxHealth > 0.f ? Health / MaxHealth : 0.f);
+	}
+}
+
+void UPlayerHUDWidget::RefreshAmmo()
+{
+	if (AmmoText == nullptr) return;
+
+	const ACrawlingChaosCharacter* CurrentCharacter = Character.Get();
+	AmmoText->SetText(CurrentCharacter && bHasAmmoType
+		? FText::AsNumber(CurrentCharacter->GetAmmo(DisplayedAmmoType))
+		: FText::GetEmpty());
+}
@@ -0,0 +1,319 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ProjectileManagerSubsystem.h"
+
+#include "../CrawlingChaos.h"
+#include "../CrawlingChaosProjectile.h"
+#include "Async/ParallelFor.h"
+#include "Components/InstancedStaticMeshComponent.h"
+#include "Components/SphereComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+
+namespace
+{
+	/** Sweeps reach this much further than the step they were predicted from, to cover frame time jitter */
+	constexpr float SweepLengthMargin{1.5f};
+
+	/** Velocity after one step of gravity and the speed cap */
+	FVector StepVelocity(const FSimulatedProjectileType& Type, FVector Velocity, const float DeltaTime)
+	{
+		Velocity.Z += Type.GravityZ * DeltaTime;
+		return Type.MaxSpeed > 0.f ? Velocity.GetClampedToMaxSize(Type.MaxSpeed) : Velocity;
+	}
+}
+
+int32 FSimulatedProjectiles::Add(const FVector& Position, const FVector& Velocity, const float Life, AActor* Owner,
+								 const uint16 TypeIndex)
+{
+	Positions.Add(Position);
+	Velocities.Add(Velocity);
+	RemainingLife.Add(Life);
+	Owners.Add(Owner);
+	TypeIndices.Add(TypeIndex);
+	SweepHandles.AddDefaulted();
+	SweepEnds.Add(Position);
+	LaunchFrames.Add(GFrameCounter);
+	INC_DWORD_STAT(STAT_ProjectilesAlive);
+	return Positions.Num() - 1;
+}
+
+void FSimulatedProjectiles::RemoveAtSwap(const int32 Index)
+{
+	Positions.RemoveAtSwap(Index, 1, false);
+	Velocities.RemoveAtSwap(Index, 1, false);
+	RemainingLife.RemoveAtSwap(Index, 1, false);
+	Owners.RemoveAtSwap(Index, 1, false);
+	TypeIndices.RemoveAtSwap(Index, 1, false);
+	SweepHandles.RemoveAtSwap(Index, 1, false);
+	SweepEnds.RemoveAtSwap(Index, 1, false);
+	LaunchFrames.RemoveAtSwap(Index, 1, false);
+	DEC_DWORD_STAT(STAT_ProjectilesAlive);
+}
+
+void UProjectileManagerSubsystem::Deinitialize()
+{
+	if (IsValid(RenderActor))
+	{
+		RenderActor->Destroy();
+	}
+	RenderActor = nullptr;
+	Types.Reset();
+	DEC_DWORD_STAT_BY(STAT_ProjectilesAlive, Projectiles.Num());
+	
+	Super::Deinitialize();
+}
+
+bool UProjectileManagerSubsystem::IsTickable() const
+{
+	// Keep ticking once anything has been registered so the instances get trimmed after the last impact
+	return Types.Num() > 0;
+}
+
+TStatId UProjectileManagerSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UProjectileManagerSubsystem, STATGROUP_Tickables);
+}
+
+bool UProjectileManagerSubsystem::CanSimulate(const TSubclassOf<ACrawlingChaosProjectile> ProjectileClass)
+{
+	if (ProjectileClass == nullptr) return false;
+
+	const ACrawlingChaosProjectile* Defaults = ProjectileClass->GetDefaultObject<ACrawlingChaosProjectile>();
+	return !Defaults->RequiresActor() && Defaults->GetSimulatedMesh() != nullptr;
+}
+
+bool UProjectileManagerSubsystem::SpawnProjectile(const TSubclassOf<ACrawlingChaosProjectile> ProjectileClass,
+												  const FVector& Location, const FRotator& Rotation, AActor* Owner)
+{
+	if (!CanSimulate(ProjectileClass)) return false;
+
+	const int32 TypeIndex = FindOrAddType(ProjectileClass);
+	if (TypeIndex == INDEX_NONE) return false;
+
+	const FSimulatedProjectileType& Type = Types[TypeIndex];
+	const int32 Index = Projectiles.Add(Location, Rotation.Vector() * Type.InitialSpeed, Type.LifeSpan, Owner,
+										static_cast<uint16>(TypeIndex));
+
+	// Cover the first step from the muzzle straight away. The projectile doesn't move until this sweep resolves next
+	// frame, so one fired point blank into a wall can't skip it
+	SubmitSweep(Index, GetWorld()->GetDeltaSeconds());
+	return true;
+}
+
+int32 UProjectileManagerSubsystem::FindOrAddType(const TSubclassOf<ACrawlingChaosProjectile> ProjectileClass)
+{
+	const int32 ExistingIndex = Types.IndexOfByPredicate([ProjectileClass](const FSimulatedProjectileType& Type)
+	{
+		return Type.ProjectileClass == ProjectileClass;
+	});
+	if (ExistingIndex != INDEX_NONE) return ExistingIndex;
+
+	UWorld* World = GetWorld();
+	if (World == nullptr || Types.Num() > MAX_uint16) return INDEX_NONE;
+
+	if (!IsValid(RenderActor))
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		RenderActor = World->SpawnActor<AActor>(SpawnParams);
+		RenderActor->SetRootComponent(NewObject<USceneComponent>(RenderActor, TEXT("Root")));
+		RenderActor->GetRootComponent()->RegisterComponent();
+	}
+
+	const ACrawlingChaosProjectile* Defaults = ProjectileClass->GetDefaultObject<ACrawlingChaosProjectile>();
+	const UProjectileMovementComponent* Movement = Defaults->GetProjectileMovement();
+	const USphereComponent* Collision = Defaults->GetCollisionComp();
+
+	FSimulatedProjectileType& Type = Types.AddDefaulted_GetRef();
+	Type.ProjectileClass = ProjectileClass;
+	Type.InitialSpeed = Movement->InitialSpeed;
+	Type.MaxSpeed = Movement->MaxSpeed;
+	Type.GravityZ = World->GetGravityZ() * Movement->ProjectileGravityScale;
+	Type.LifeSpan = Defaults->InitialLifeSpan > 0.f ? Defaults->InitialLifeSpan : 3.f;
+	Type.Radius = Collision->GetUnscaledSphereRadius();
+	Type.CollisionChannel = Collision->GetCollisionObjectType();
+	Type.ResponseParams.CollisionResponse = Collision->GetCollisionResponseToChannels();
+
+	Type.Instances = NewObject<UInstancedStaticMeshComponent>(RenderActor);
+	Type.Instances->SetStaticMesh(Defaults->GetSimulatedMesh());
+	Type.Instances->SetMobility(EComponentMobility::Movable);
+	Type.Instances->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Type.Instances->SetCastShadow(false);
+	Type.Instances->SetupAttachment(RenderActor->GetRootComponent());
+	Type.Instances->RegisterComponent();
+	
+	return Types.Num() - 1;
+}
+
+void UProjectileManagerSubsystem::SubmitSweep(const int32 Index, const float DeltaTime)
+{
+	const FSimulatedProjectileType& Type = Types[Projectiles.TypeIndices[Index]];
+	const FVector& Start = Projectiles.Positions[Index];
+	const FVector Step{Projectiles.Velocities[Index] * DeltaTime * SweepLengthMargin};
+
+	const FCollisionQueryParams QueryParams{SCENE_QUERY_STAT(SimulatedProjectile), false, Projectiles.Owners[Index].Get()};
+	CRAWLINGCHAOS_COUNT_TRACES(1);
+	Projectiles.SweepEnds[Index] = Start + Step;
+	Projectiles.SweepHandles[Index] = GetWorld()->AsyncSweepByChannel(EAsyncTraceType::Single, Start, Start + Step,
+																	  FQuat::Identity, Type.CollisionChannel,
+																	  FCollisionShape::MakeSphere(Type.Radius),
+																	  QueryParams, Type.ResponseParams);
+}
+
+bool UProjectileManagerSubsystem::SweepNow(const int32 Index, const FVector& Start, const FVector& End, FHitResult& OutHit) const
+{
+	const FSimulatedProjectileType& Type = Types[Projectiles.TypeIndices[Index]];
+
+	const FCollisionQueryParams QueryParams{SCENE_QUERY_STAT(SimulatedProjectile), false, Projectiles.Owners[Index].Get()};
+	CRAWLINGCHAOS_COUNT_TRACES(1);
+	return GetWorld()->SweepSingleByChannel(OutHit, Start, End, FQuat::Identity, Type.CollisionChannel,
+											FCollisionShape::MakeSphere(Type.Radius), QueryParams, Type.ResponseParams);
+}
+
+void UProjectileManagerSubsystem::Tick(const float DeltaTime)
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr) return;
+	
+	const int32 NumProjectiles = Projectiles.Num();
+	const uint64 Frame = GFrameCounter;
+	
+	// Resolve the sweeps queued last frame. A hit only counts if it's within the distance actually travelled this
+	// frame; anything further out is picked up by the next sweep
+	TArray<FHitResult> ImpactHits;
+	TArray<int32> ImpactIndices;
+	FTraceDatum TraceDatum;
+	for (int32 Index = 0; Index < NumProjectiles; ++Index)
+	{
+		// Launched this frame; it holds at the muzzle and its first sweep is still pending
+		if (Projectiles.LaunchFrames[Index] == Frame) continue;
+
+		const FSimulatedProjectileType& Type = Types[Projectiles.TypeIndices[Index]];
+		const FVector& Position = Projectiles.Positions[Index];
+		const FVector StepEnd = Position + StepVelocity(Type, Projectiles.Velocities[Index], DeltaTime) * DeltaTime;
+		const float StepLength = FVector::Dist(Position, StepEnd);
+
+		// Without a result nothing of the step has been checked yet
+		FVector SweptEnd = Position;
+		if (World->QueryTraceData(Projectiles.SweepHandles[Index], TraceDatum))
+		{
+			if (TraceDatum.OutHits.Num() > 0 && TraceDatum.OutHits[0].bBlockingHit)
+			{
+				const FHitResult& Hit = TraceDatum.OutHits[0];
+				if (Hit.Distance <= StepLength)
+				{
+					ImpactHits.Add(Hit);
+					ImpactIndices.Add(Index);
+					Projectiles.RemainingLife[Index] = 0.f;
+				}
+				// A blocker further out than the step means the step itself is clear
+				continue;
+			}
+			SweptEnd = Projectiles.SweepEnds[Index];
+		}
+
+		// A hitch can carry the projectile past the end of what was swept; cover the rest now so it can't pass
+		// through whatever is there
+		if (StepLength <= FVector::Dist(Position, SweptEnd)) continue;
+
+		FHitResult Hit;
+		if (SweepNow(Index, SweptEnd, StepEnd, Hit))
+		{
+			ImpactHits.Add(Hit);
+			ImpactIndices.Add(Index);
+			Projectiles.RemainingLife[Index] = 0.f;
+		}
+	}
+
+	// Integrate everything in one pass. Anything launched this frame holds at the muzzle until its first sweep is back
+	Transforms.SetNumUninitialized(NumProjectiles, false);
+	ParallelFor(NumProjectiles, [this, DeltaTime, Frame](const int32 Index)
+	{
+		const FSimulatedProjectileType& Type = Types[Projectiles.TypeIndices[Index]];
+		FVector& Velocity = Projectiles.Velocities[Index];
+		FVector& Position = Projectiles.Positions[Index];
+		if (Projectiles.LaunchFrames[Index] == Frame)
+		{
+			Transforms[Index] = FTransform{FRotationMatrix::MakeFromX(Velocity).ToQuat(), Position};
+			return;
+		}
+
+		Velocity = StepVelocity(Type, Velocity, DeltaTime);
+		Position += Velocity * DeltaTime;
+		Projectiles.RemainingLife[Index] -= DeltaTime;
+
+		Transforms[Index] = FTransform{FRotationMatrix::MakeFromX(Velocity).ToQuat(), Position};
+	});
+
+	// Broadcast impacts before anything is removed so the owners are still at their original indices
+	for (int32 ImpactIndex = 0; ImpactIndex < ImpactIndices.Num(); ++ImpactIndex)
+	{
+		const int32 Index = ImpactIndices[ImpactIndex];
+		OnProjectileImpact.Broadcast(Types[Projectiles.TypeIndices[Index]].ProjectileClass,
+									 Projectiles.Owners[Index].Get(), ImpactHits[ImpactIndex]);
+	}
+
+	// Retire spent projectiles, walking backwards so swapped-in entries have already been visited
+	for (int32 Index = NumProjectiles - 1; Index >= 0; --Index)
+	{
+		if (Projectiles.RemainingLife[Index] <= 0.f)
+		{
+			Projectiles.RemoveAtSwap(Index);
+			Transforms.RemoveAtSwap(Index, 1, false);
+		}
+	}
+
+	for (int32 Index = 0; Index < Projectiles.Num(); ++Index)
+	{
+		// Launched this frame; the sweep from the muzzle is still pending
+		if (Projectiles.LaunchFrames[Index] == Frame) continue;
+		
+		SubmitSweep(Index, DeltaTime);
+	}
+
+	UpdateInstances();
+}
+
+void UProjectileManagerSubsystem::UpdateInstances()
+{
+	for (FSimulatedProjectileType& Type : Types)
+	{
+		Type.InstanceTransforms.Reset();
+	}
+	for (int32 Index = 0; Index < Transforms.Num(); ++Index)
+	{
+		Types[Projectiles.TypeIndices[Index]].InstanceTransforms.Add(Transforms[Index]);
+	}
+
+	for (FSimulatedProjectileType& Type : Types)
+	{
+		if (!IsValid(Type.Instances)) continue;
+		
+		// Keep the instance count in step with the projectile count by growing or trimming the tail
+		const int32 NumInstances = Type.Instances->GetInstanceCount();
+		const int32 NumNeeded = Type.InstanceTransforms.Num();
+		if (NumInstances < NumNeeded)
+		{
+			TArray<FTransform> NewInstances;
+			NewInstances.Init(FTransform::Identity, NumNeeded - NumInstances);
+			Type.Instances->AddInstances(NewInstances, false, true);
+		}
+		else if (NumInstances > NumNeeded)
+		{
+			TArray<int32> InstancesToRemove;
+			InstancesToRemove.Reserve(NumInstances - NumNeeded);
+			for (int32 InstanceIndex = NumNeeded; InstanceIndex < NumInstances; ++InstanceIndex)
+			{
+				InstancesToRemove.Add(InstanceIndex);
+			}
+			Type.Instances->RemoveInstances(InstancesToRemove);
+		}
+
+		if (NumNeeded > 0)
+		{
+			Type.Instances->BatchUpdateInstancesTransforms(0, Type.InstanceTransforms, true, true, true);
+		}
+	}
+}
@@ -0,0 +1,97 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ProjectileManagerSubsystem.h"
+
+#include "../CrawlingChaos.h"
+#include "../CrawlingChaosProjectile.h"
+#include "Components/BoxComponent.h"
+#include "Engine/CollisionProfile.h"
+#include "Engine/Engine.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/World.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/ScopeExit.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace
+{
+	/** An ordinary frame, then one long enough that the projectile travels well past what its sweep predicted */
+	constexpr float FrameSeconds{1.f / 60.f};
+	constexpr float HitchSeconds{0.5f};
+
+	/** The wall is thinner than a projectile's radius and sits beyond the first sweep but inside the hitch step */
+	constexpr float WallDistance{400.f};
+	const FVector WallExtent{1.f, 500.f, 500.f};
+
+	void TickWorld(UWorld* World, const float DeltaTime)
+	{
+		++GFrameCounter;
+		World->Tick(LEVELTICK_All, DeltaTime);
+	}
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FProjectileHitchTest, "CrawlingChaos.Projectiles.HitchAgainstThinWall",
+								 EAutomationTestFlags::ApplicationContextMask | EAutomationTestFlags::ProductFilter)
+
+bool FProjectileHitchTest::RunTest(const FString& Parameters)
+{
+	UStaticMesh* Mesh = LoadObject<UStaticMesh>(nullptr, TEXT("/Engine/BasicShapes/Sphere.Sphere"));
+	if (!TestNotNull(TEXT("Simulated projectile mesh"), Mesh)) return false;
+
+	// Have the manager simulate the base projectile class for the length of the test
+	ACrawlingChaosProjectile* Defaults = GetMutableDefault<ACrawlingChaosProjectile>();
+	const FBoolProperty* RequiresActorProperty = FindFProperty<FBoolProperty>(ACrawlingChaosProjectile::StaticClass(), TEXT("bRequiresActor"));
+	const FObjectProperty* SimulatedMeshProperty = FindFProperty<FObjectProperty>(ACrawlingChaosProjectile::StaticClass(), TEXT("SimulatedMesh"));
+	const bool bOldRequiresActor = RequiresActorProperty->GetPropertyValue_InContainer(Defaults);
+	UObject* OldSimulatedMesh = SimulatedMeshProperty->GetObjectPropertyValue_InContainer(Defaults);
+	RequiresActorProperty->SetPropertyValue_InContainer(Defaults, false);
+	SimulatedMeshProperty->SetObjectPropertyValue_InContainer(Defaults, Mesh);
+
+	UWorld* World = UWorld::CreateWorld(EWorldType::Game, false);
+	FWorldContext& WorldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	WorldContext.SetCurrentWorld(World);
+
+	ON_SCOPE_EXIT
+	{
+		GEngine->DestroyWorldContext(World);
+		World->DestroyWorld(false);
+		RequiresActorProperty->SetPropertyValue_InContainer(Defaults, bOldRequiresActor);
+		SimulatedMeshProperty->SetObjectPropertyValue_InContainer(Defaults, OldSimulatedMesh);
+	};
+
+	AActor* Wall = World->SpawnActor<AActor>();
+	UBoxComponent* WallBox = NewObject<UBoxComponent>(Wall);
+	WallBox->SetBoxExtent(WallExtent);
+	WallBox->SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+	Wall->SetRootComponent(WallBox);
+	WallBox->SetWorldLocation(FVector{WallDistance, 0.f, 0.f});
+	WallBox->RegisterComponent();
+
+	UProjectileManagerSubsystem* Manager = World->GetSubsystem<UProjectileManagerSubsystem>();
+	if (!TestNotNull(TEXT("Projectile manager"), Manager)) return false;
+
+	const AActor* HitActor = nullptr;
+	Manager->OnProjectileImpact.AddLambda([&HitActor](TSubclassOf<ACrawlingChaosProjectile>, AActor*, const FHitResult& Hit)
+	{
+		HitActor = Hit.GetActor();
+	});
+
+	// Settle the wall into the scene and give the world an ordinary frame time to predict the first sweep from
+	TickWorld(World, FrameSeconds);
+	if (!TestTrue(TEXT("Projectile launched"), Manager->SpawnProjectile(ACrawlingChaosProjectile::StaticClass(),
+																		 FVector::ZeroVector, FRotator::ZeroRotator, nullptr)))
+	{
+		return false;
+	}
+
+	TickWorld(World, FrameSeconds);
+	TickWorld(World, HitchSeconds);
+
+	TestEqual(TEXT("Projectile hit the wall"), HitActor, static_cast<const AActor*>(Wall));
+	TestEqual(TEXT("Projectiles left in flight"), Manager->GetNumProjectiles(), 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ProjectilePoolSubsystem.h"
+
+#include "../CrawlingChaos.h"
+#include "../CrawlingChaosProjectile.h"
+#include "Engine/World.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogProjectilePool, Log, All);
+
+namespace
+{
+	FAutoConsoleCommandWithWorld DumpProjectilePoolStatsCommand(
+		TEXT("CrawlingChaos.ProjectilePoolStats"),
+		TEXT("Log the hit, miss and high-water counts of every projectile pool"),
+		FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+		{
+			if (const UProjectilePoolSubsystem* Pool = World ? World->GetSubsystem<UProjectilePoolSubsystem>() : nullptr)
+			{
+				Pool->DumpStats();
+			}
+		}));
+}
+
+void UProjectilePoolSubsystem::Prewarm(const TSubclassOf<ACrawlingChaosProjectile> ProjectileClass)
+{
+	if (ProjectileClass == nullptr) return;
+
+	FProjectilePool& Pool = Pools.FindOrAdd(ProjectileClass);
+	const int32 PrewarmCount = ProjectileClass->GetDefaultObject<ACrawlingChaosProjectile>()->GetPoolPrewarmCount();
+	while (Pool.Free.Num() + Pool.Stats.InUse < PrewarmCount)
+	{
+		ACrawlingChaosProjectile* Projectile = SpawnPooledProjectile(ProjectileClass);
+		if (Projectile == nullptr) break;
+		
+		Pool.Free.Add(Projectile);
+	}
+}
+
+ACrawlingChaosProjectile* UProjectilePoolSubsystem::Acquire(const TSubclassOf<ACrawlingChaosProjectile> ProjectileClass,
+															const FVector& Location, const FRotator& Rotation,
+															AActor* NewOwner)
+{
+	if (ProjectileClass == nullptr) return nullptr;
+
+	FProjectilePool& Pool = Pools.FindOrAdd(ProjectileClass);
+	
+	// Anything destroyed out from under us (level teardown, etc.) just gets skipped
+	ACrawlingChaosProjectile* Projectile = nullptr;
+	while (Projectile == nullptr && Pool.Free.Num() > 0)
+	{
+		ACrawlingChaosProjectile* Candidate = Pool.Free.Pop(false);
+		if (IsValid(Candidate))
+		{
+			Projectile = Candidate;
+		}
+	}
+
+	if (Projectile)
+	{
+		++Pool.Stats.Hits;
+	}
+	else
+	{
+		++Pool.Stats.Misses;
+		Projectile = SpawnPooledProjectile(ProjectileClass);
+		if (Projectile == nullptr) return nullptr;
+	}
+
+	Pool.Stats.InUse++;
+	Pool.Stats.HighWater = FMath::Max(Pool.Stats.HighWater, Pool.Stats.InUse);
+	
+	Projectile->ActivateFromPool(Location, Rotation, NewOwner);
+	INC_DWORD_STAT(STAT_ProjectilesAlive);
+	return Projectile;
+}
+
+void UProjectilePoolSubsystem::Release(ACrawlingChaosProjectile* Projectile)
+{
+	if (!IsValid(Projectile) || !Projectile->IsActiveInPool()) return;
+
+	Projectile->DeactivateToPool();
+	
+	FProjectilePool& Pool = Pools.FindOrAdd(Projectile->GetClass());
+	Pool.Stats.InUse = FMath::Max(Pool.Stats.InUse - 1, 0);
+	DEC_DWORD_STAT(STAT_ProjectilesAlive);
+	Pool.Free.Add(Projectile);
+}
+
+FProjectilePoolStats UProjectilePoolSubsystem::GetStats(const TSubclassOf<ACrawlingChaosProjectile> ProjectileClass) const
+{
+	const FProjectilePool* Pool = Pools.Find(ProjectileClass);
+	return Pool ? Pool->Stats : FProjectilePoolStats{};
+}
+
+void UProjectilePoolSubsystem::DumpStats() const
+{
+	for (const TPair<UClass*, FProjectilePool>& Pair : Pools)
+	{
+		const FProjectilePoolStats& Stats = Pair.Value.Stats;
+		UE_LOG(LogProjectilePool, Log, TEXT("%s: %d hits, %d misses, %d in use, %d high-water, %d free"),
+			   *GetNameSafe(Pair.Key), Stats.Hits, Stats.Misses, Stats.InUse, Stats.HighWater, Pair.Value.Free.Num());
+	}
+}
+
+ACrawlingChaosProjectile* UProjectilePoolSubsystem::SpawnPooledProjectile(UClass* ProjectileClass) const
+{
+	UWorld* World = GetWorld();
+	if (World == nullptr) return nullptr;
+	
+	FActorSpawnParameters ActorSpawnParams;
+	ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	ACrawlingChaosProjectile* Projectile = World->SpawnActor<ACrawlingChaosProjectile>(ProjectileClass, FTransform::Identity,
+																					  ActorSpawnParams);
+	if (Projectile)
+	{
+		Projectile->DeactivateToPool();
+	}
+	return Projectile;
+}
@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "SpreadPattern.h"
+
+namespace
+{
+	/** Entries in the jitter table; a power of two so hashes can be masked into it */
+	constexpr int32 JitterTableSize{256};
+
+	/** Uniform point in the unit disc */
+	FVector2D RandomPointInDisc(const FRandomStream& Stream)
+	{
+		const float Radius = FMath::Sqrt(Stream.GetFraction());
+		float Sin;
+		float Cos;
+		FMath::SinCos(&Sin, &Cos, Stream.GetFraction() * 2.f * PI);
+		return FVector2D{Radius * Cos, Radius * Sin};
+	}
+
+	/** Murmur3 finalizer; spreads every input bit over the whole output */
+	uint32 MixBits(uint32 Value)
+	{
+		Value ^= Value >> 16;
+		Value *= 0x85ebca6bu;
+		Value ^= Value >> 13;
+		Value *= 0xc2b2ae35u;
+		Value ^= Value >> 16;
+		return Value;
+	}
+}
+
+USpreadPattern::USpreadPattern() :
+	NumOffsets(32),
+	bRestartEachShot(false),
+	CandidatesPerOffset(16),
+	BakeSeed(0),
+	JitterScale(0.1f),
+	BakedNumOffsets(0),
+	BakedCandidatesPerOffset(0),
+	BakedSeed(0)
+{
+}
+
+void USpreadPattern::Bake()
+{
+	Modify();
+
+	// Mitchell's best-candidate: each new offset is the candidate furthest from every offset placed so far, which
+	// gives a blue-noise distribution where every prefix of the list is evenly spread too
+	const FRandomStream Stream{BakeSeed};
+	Offsets.Reset(NumOffsets);
+	for (int32 OffsetIndex = 0; OffsetIndex < NumOffsets; ++OffsetIndex)
+	{
+		FVector2D Best{RandomPointInDisc(Stream)};
+		float BestDistanceSquared = -1.f;
+		for (int32 Candidate = 0; Candidate < CandidatesPerOffset && Offsets.Num() > 0; ++Candidate)
+		{
+			const FVector2D Point{Candidate == 0 ? Best : RandomPointInDisc(Stream)};
+			float NearestSquared = TNumericLimits<float>::Max();
+			for (const FVector2D& Placed : Offsets)
+			{
+				NearestSquared = FMath::Min(NearestSquared, FVector2D::DistSquared(Point, Placed));
+			}
+			if (NearestSquared > BestDistanceSquared)
+			{
+				BestDistanceSquared = NearestSquared;
+				Best = Point;
+			}
+		}
+		Offsets.Add(Best);
+	}
+
+	const FRandomStream JitterStream{static_cast<int32>(MixBits(static_cast<uint32>(BakeSeed) + 1))};
+	JitterTable.SetNumUninitialized(JitterTableSize);
+	for (FVector2D& Jitter : JitterTable)
+	{
+		Jitter = RandomPointInDisc(JitterStream);
+	}
+
+	BakedNumOffsets = NumOffsets;
+	BakedCandidatesPerOffset = CandidatesPerOffset;
+	BakedSeed = BakeSeed;
+}
+
+void USpreadPattern::GetPelletOffsets(const uint32 Seed, const uint32 ShotIndex, TArrayView<FVector2D> OutOffsets) const
+{
+	if (Offsets.Num() == 0 || JitterTable.Num() != JitterTableSize)
+	{
+		for (FVector2D& Offset : OutOffsets)
+		{
+			Offset = FVector2D::ZeroVector;
+		}
+		return;
+	}
+
+	const uint32 ShotHash = HashShot(Seed, ShotIndex);
+	const uint32 FirstOffset = bRestartEachShot ? 0 : ShotIndex * OutOffsets.Num();
+	for (int32 PelletIndex = 0; PelletIndex < OutOffsets.Num(); ++PelletIndex)
+	{
+		const FVector2D& Base = Offsets[(FirstOffset + PelletIndex) % Offsets.Num()];
+		const FVector2D& Jitter = JitterTable[MixBits(ShotHash + PelletIndex) & (JitterTableSize - 1)];
+		OutOffsets[PelletIndex] = Base + Jitter * JitterScale;
+	}
+}
+
+uint32 USpreadPattern::HashShot(const uint32 Seed, const uint32 ShotIndex)
+{
+	return MixBits(Seed ^ MixBits(ShotIndex));
+}
+
+bool USpreadPattern::IsBaked() const
+{
+	return Offsets.Num() == NumOffsets && JitterTable.Num() == JitterTableSize && BakedNumOffsets == NumOffsets &&
+		BakedCandidatesPerOffset == CandidatesPerOffset && BakedSeed == BakeSeed;
+}
+
+#if WITH_EDITOR
+void USpreadPattern::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
+
+	if (!IsBaked())
+	{
+		Bake();
+	}
+}
+#endif
+
+// Called on save and when cooking, so a cooked pattern is always baked
+void USpreadPattern::PreSave(FObjectPreSaveContext ObjectSaveContext)
+{
+	if (!IsBaked())
+	{
+		Bake();
+	}
+
+	Super::PreSave(ObjectSaveContext);
+}
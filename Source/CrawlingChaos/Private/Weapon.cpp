@@ -3,27 +3,121 @@
 
 #include "Weapon.h"
 
+#include "DamageQueueSubsystem.h"
+#include "ImpactEffectSubsystem.h"
+#include "ImpulseAccumulatorSubsystem.h"
+#include "ProjectileManagerSubsystem.h"
+#include "ProjectilePoolSubsystem.h"
+#include "WeaponAssetSubsystem.h"
+#include "WeaponAudioSubsystem.h"
+#include "WeaponDefinitionSubsystem.h"
+#include "WeaponInstance.h"
+#include "../CrawlingChaos.h"
 #include "../CrawlingChaosCharacter.h"
 #include "../CrawlingChaosProjectile.h"
 #include "NiagaraFunctionLibrary.h"
 #include "Components/CapsuleComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
 #include "Sound/SoundCue.h"
 #include "Components/SphereComponent.h"
-#include "Kismet/GameplayStatics.h"
+#include "GameFramework/DamageType.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "NiagaraComponent.h"
+#include "NiagaraDataInterfaceArrayFunctionLibrary.h"
 
+DECLARE_CYCLE_STAT(TEXT("Weapon OnFire"), STAT_WeaponOnFire, STATGROUP_CrawlingChaos);
+DECLARE_CYCLE_STAT(TEXT("Weapon Trace For Hits"), STAT_WeaponTraceForHits, STATGROUP_CrawlingChaos);
+DECLARE_CYCLE_STAT(TEXT("Weapon Resolve Fire Batch"), STAT_WeaponResolveFireBatch, STATGROUP_CrawlingChaos);
+DECLARE_CYCLE_STAT(TEXT("Weapon Spawn Projectile"), STAT_WeaponSpawnProjectile, STATGROUP_CrawlingChaos);
+DECLARE_CYCLE_STAT(TEXT("Weapon Collected"), STAT_WeaponCollected, STATGROUP_CrawlingChaos);
+
+namespace
+{
+	/** How far the camera ray of each pellet reaches */
+	constexpr float WeaponTraceDistance{50'000.f};
+
+	/** Flag in the trace user data marking the muzzle trace of a pellet */
+	constexpr uint32 MuzzleTraceFlag{1u << 15};
+
+	/** Mask for the pellet index in the trace user data */
+	constexpr uint32 PelletIndexMask{MuzzleTraceFlag - 1};
+
+	/** Change in speed a single pellet gives whatever it hits, in cm/s */
+	constexpr float PelletImpulsePerUnitMass{400.f};
+
+	/** Array parameters the tracer system reads its beams from */
+	const FName TracerBeamStartsParameter{TEXT("BeamStarts")};
+	const FName TracerBeamEndsParameter{TEXT("BeamEnds")};
+
+	/** Component setup for each item state, indexed by EItemState, with anything unknown last */
+	const FItemComponentState ItemStateComponents[] =
+	{
+		// Pickup: we want to be able to see the mesh and collect it, but that's it; the pickup subsystem finds it
+		{true, true, ECollisionEnabled::NoCollision, ECR_Ignore, false, false, true, true},
+		// PickedUp: no collision, can't see it, etc. Shadows stay off so swapping with the equipped state only
+		// toggles visibility
+		{false, false, ECollisionEnabled::NoCollision, ECR_Ignore, false, false, false, false},
+		// Equipped: no shadows, but we can see the mesh and not collide with it
+		{true, false, ECollisionEnabled::NoCollision, ECR_Ignore, false, false, false, false},
+		// Anything else: hide the mesh, disable physics and collision
+		{false, false, ECollisionEnabled::NoCollision, ECR_Ignore, false, false, false, false},
+	};
+	static_assert(UE_ARRAY_COUNT(ItemStateComponents) == static_cast<int32>(EItemState::EIS_MAX) + 1,
+				  "Every item state needs a component setup");
+
+	/** In game, whatever the streamer has loaded so far; in the editor, load it on the spot */
+	template <typename T>
+	T* ResolveAsset(const TSoftObjectPtr<T>& Asset, const UWorld* World)
+	{
+		return World && World->IsGameWorld() ? Asset.Get() : Asset.LoadSynchronous();
+	}
+}
+
+
+void FWeaponDataTable::GetStreamedAssets(TArray<FSoftObjectPath>& OutAssets) const
+{
+	auto AddAsset = [&OutAssets](const FSoftObjectPath& Path)
+	{
+		if (!Path.IsNull())
+		{
+			OutAssets.Add(Path);
+		}
+	};
+	
+	AddAsset(ItemMesh.ToSoftObjectPath());
+	AddAsset(PickupStaticMesh.ToSoftObjectPath());
+	AddAsset(MaterialInstance.ToSoftObjectPath());
+	AddAsset(MuzzleFlash.ToSoftObjectPath());
+	AddAsset(FireAnimation.ToSoftObjectPath());
+	AddAsset(AnimBP.ToSoftObjectPath());
+	AddAsset(InventoryIcon.ToSoftObjectPath());
+	AddAsset(FireSound.ToSoftObjectPath());
+	AddAsset(FireLoopSound.ToSoftObjectPath());
+	AddAsset(FireTailSound.ToSoftObjectPath());
+	AddAsset(PickupSound.ToSoftObjectPath());
+	AddAsset(EquipSound.ToSoftObjectPath());
+	AddAsset(HitParticleSystem.ToSoftObjectPath());
+	AddAsset(TracerParticleSystem.ToSoftObjectPath());
+}
 
 // Sets default values
 AWeapon::AWeapon() :
-	AutoFireRate(.1f),
-	bCanFire(true) // By default, you should be able to shoot the weapon
+	ItemState(EItemState::EIS_Pickup),
+	Instance(nullptr),
+	NextFireBatchId(0),
+	TracerBeamFrame(0),
+	bTracerBeamsPending(false),
+	Definition(&UWeaponDefinitionSubsystem::GetEmptyDefinition())
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+ 	// Weapons only tick while rounds are queued; fire resolves through async trace callbacks and pickups bob through
+	// the oscillation subsystem
 	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = false;
 
-	// todo: going to need to port item state over
-	AreaSphere->OnComponentBeginOverlap.AddDynamic(this, &AWeapon::OnSphereOverlap);
+	TracerComponent = CreateDefaultSubobject<UNiagaraComponent>(TEXT("TracerComponent"));
+	// Moved onto the muzzle once the item mesh exists
+	TracerComponent->SetupAttachment(GetRootComponent());
+	TracerComponent->SetAutoActivate(false);
 }
 
 // Called when the game starts or when spawned
@@ -31,92 +125,126 @@ void AWeapon::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// Set the item properties
-	SetItemProperties(EItemState::EIS_Pickup);
+	PelletTraceDelegate.BindUObject(this, &AWeapon::OnPelletTraceCompleted);
+	PrewarmProjectiles();
+
+	// Assets stream in while a pickup is nearby or the weapon is owned; show them as soon as they arrive
+	if (UWeaponAssetSubsystem* WeaponAssets = GetWorld()->GetSubsystem<UWeaponAssetSubsystem>())
+	{
+		WeaponAssets->OnWeaponAssetsLoaded.AddUObject(this, &AWeapon::OnWeaponAssetsLoaded);
+	}
+
+	// Set the item properties; anything not handed a state before play is a pickup
+	SetItemProperties(ItemState);
+}
+
+// Called when the weapon is destroyed or its level unloaded
+void AWeapon::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UWeaponAssetSubsystem* WeaponAssets = GetWorld()->GetSubsystem<UWeaponAssetSubsystem>())
+	{
+		WeaponAssets->OnWeaponAssetsLoaded.RemoveAll(this);
+	}
+	
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called when the actor is spawned, moved, or a property is changed
 void AWeapon::OnConstruction(const FTransform& Transform)
 {
 	Super::OnConstruction(Transform);
-	
-	const FString weaponTablePath{TEXT("DataTable'/Game/_Game/Weapons/DataTables/WeaponDataTable.WeaponDataTable'")};
-	UDataTable* weaponTableObject = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(),nullptr,*weaponTablePath));
 
-	if (weaponTableObject)
+	ResolveDefinition();
+	ApplyDefinitionMesh();
+}
+
+// Called for both spawned and level-loaded weapons, which don't rerun their construction script
+void AWeapon::PostInitializeComponents()
+{
+	Super::PostInitializeComponents();
+
+	ResolveDefinition();
+}
+
+void AWeapon::ResolveDefinition()
+{
+	Definition = UWeaponDefinitionSubsystem::FindDefinition(WeaponType);
+	PickupStaticMesh = Definition->PickupStaticMesh;
+	SetMaterialData(ItemMaterialData::Glow, Definition->Glow);
+	SetMaterialData(ItemMaterialData::Tint, Definition->RarityTint);
+	TracerComponent->SetAsset(ResolveAsset(Definition->TracerParticleSystem, GetWorld()));
+}
+
+void AWeapon::ApplyDefinitionMesh()
+{
+	// Pickups drawn as instances never need one
+	if (ItemMesh == nullptr) return;
+	
+	ItemMesh->SetSkeletalMesh(ResolveAsset(Definition->ItemMesh, GetWorld()));
+	
+	// Every weapon of the type shares the one material, so they can batch together
+	if (UMaterialInstance* MaterialInstance = ResolveAsset(Definition->MaterialInstance, GetWorld()))
 	{
-		FWeaponDataTable* weaponDataRow = nullptr;
-		switch (WeaponType)
-		{
-		case EWeaponType::EWT_Rifle:
-			weaponDataRow = weaponTableObject->FindRow<FWeaponDataTable>(FName("Rifle"), TEXT(""));
-			break;
-		case EWeaponType::EWT_RocketLauncher:
-			weaponDataRow = weaponTableObject->FindRow<FWeaponDataTable>(FName("RocketLauncher"), TEXT(""));
-			break;
-		case EWeaponType::EWT_Shotgun:
-			weaponDataRow = weaponTableObject->FindRow<FWeaponDataTable>(FName("Shotgun"), TEXT(""));
-			break;
-		case EWeaponType::EWT_PlasmaGun:
-			weaponDataRow = weaponTableObject->FindRow<FWeaponDataTable>(FName("PlasmaGun"), TEXT(""));
-			break;
-		default:
-			break;
-		}
+		ItemMesh->SetMaterial(0, MaterialInstance);
+	}
+}
+
+void AWeapon::OnItemMeshCreated()
+{
+	TracerComponent->AttachToComponent(ItemMesh, FAttachmentTransformRules::SnapToTargetNotIncludingScale, TEXT("Muzzle"));
+	ApplyDefinitionMesh();
+}
 
-		ItemName = weaponDataRow->ItemName;
-		WeaponType = weaponDataRow->WeaponType;
-		DamageMode = weaponDataRow->DamageMode;
-		GunOffset = weaponDataRow->GunOffset;
-		AmmoType = weaponDataRow->AmmoType;
-		WeaponAmmo = weaponDataRow->WeaponAmmo;
-		NumberOfShots = weaponDataRow->NumberOfShots;
-		FireMode = weaponDataRow->FireMode;
-		AutoFireRate = weaponDataRow->AutoFireRate;
-		ItemMesh->SetSkeletalMesh(weaponDataRow->ItemMesh);
-		MaterialInstance = weaponDataRow->MaterialInstance;
-		MuzzleFlash = weaponDataRow->MuzzleFlash;
-		ProjectileClass = weaponDataRow->Projectile;
-		AnimBP = weaponDataRow->AnimBP;
-		InventoryIcon = weaponDataRow->InventoryIcon;
-		FireSound = weaponDataRow->FireSound;
-		PickupSound = weaponDataRow->PickupSound;
-		EquipSound = weaponDataRow->EquipSound;
-		HitParticleSystem = weaponDataRow->HitParticleSystem;
-		HorizontalSpread = weaponDataRow->HorizontalSpread;
-		VerticalSpread = weaponDataRow->VerticalSpread;
-		TracerParticleSystem = weaponDataRow->TracerParticleSystem;
-		
-		if (MaterialInstance)
+void AWeapon::OnWeaponAssetsLoaded(const EWeaponType LoadedWeaponType)
+{
+	if (LoadedWeaponType != WeaponType) return;
+
+	TracerComponent->SetAsset(Definition->TracerParticleSystem.Get());
+	ApplyDefinitionMesh();
+	UpdatePickupInstance();
+}
+
+void AWeapon::PrewarmProjectiles() const
+{
+	if (Definition->DamageMode == EDamageMode::EDM_PROJECTILE && !UProjectileManagerSubsystem::CanSimulate(Definition->Projectile))
+	{
+		if (UProjectilePoolSubsystem* ProjectilePool = GetWorld()->GetSubsystem<UProjectilePoolSubsystem>())
 		{
-			DynamicMaterialInstance = UMaterialInstanceDynamic::Create(MaterialInstance, this);
-			GetItemMesh()->SetMaterial(0, DynamicMaterialInstance);
+			ProjectilePool->Prewarm(Definition->Projectile);
 		}
 	}
 }
 
-void AWeapon::OnSphereOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
-	UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+void AWeapon::SetInstance(UWeaponInstance* NewInstance)
 {
-	if (OtherActor)
-	{
-		const auto Actor = Cast<ACrawlingChaosCharacter>(OtherActor);
-		if (Actor)
-		{
-			bool bShouldDestroy = true;
-			Actor->AddAmmoOfType(AmmoType, WeaponAmmo);
+	if (NewInstance == Instance) return;
 
-			if (!Actor->AlreadyHasWeapon(WeaponType))
-			{
-				bShouldDestroy = false;
-				Actor->AddWeaponToInventory(this);
-			}
+	// Whatever was queued belongs to the weapon being put away; its cooldown stays with it
+	StopFiring();
+	
+	Instance = NewInstance;
+	if (Instance == nullptr) return;
 
-			if (bShouldDestroy)
-			{
-				Destroy();
-			}
+	WeaponType = Instance->GetWeaponType();
+	ResolveDefinition();
+	ApplyDefinitionMesh();
+	PrewarmProjectiles();
+}
+
+void AWeapon::OnCollected(ACrawlingChaosCharacter* Collector)
+{
+	CRAWLINGCHAOS_SCOPE_CYCLE_COUNTER(STAT_WeaponCollected);
+	
+	if (Collector && ItemState == EItemState::EIS_Pickup)
+	{
+		Collector->AddAmmoOfType(Definition->AmmoType, Definition->WeaponAmmo);
+
+		// The inventory only needs to know the weapon type; the pickup itself is done
+		if (!Collector->AlreadyHasWeapon(WeaponType))
+		{
+			Collector->AddWeaponToInventory(WeaponType);
 		}
+		Destroy();
 	}
 }
 
@@ -127,102 +255,166 @@ float AWeapon::GetRateOfFire() const
 	 * (rpm) * 1/60 (m/s) = rounds per second  
 	 * 1 / (r/s) = X seconds per round
 	 */
-	return UKismetMathLibrary::SafeDivide(1.f, (AutoFireRate * (1.f/60.f)));
+	return UKismetMathLibrary::SafeDivide(1.f, (Definition->AutoFireRate * (1.f/60.f)));
 }
 
 void AWeapon::SetItemState(EItemState NewItemState)
 {
+	if (NewItemState != EItemState::EIS_Equipped)
+	{
+		StopFiring();
+	}
 	ItemState = NewItemState;
 	SetItemProperties(NewItemState);
 }
 
 void AWeapon::SetItemProperties(EItemState NewItemState)
 {
-	switch (NewItemState)
+	const int32 StateIndex = FMath::Min(static_cast<int32>(NewItemState), static_cast<int32>(EItemState::EIS_MAX));
+	ApplyComponentState(ItemStateComponents[StateIndex]);
+	SetMaterialData(ItemMaterialData::PickupPulse, NewItemState == EItemState::EIS_Pickup ? 1.f : 0.f);
+}
+
+void AWeapon::TraceForHitsAndSpawnAttacks(UWorld* const World, const TArray<double>& RoundTimes, const int32 PelletsPerRound)
+{
+	CRAWLINGCHAOS_SCOPE_CYCLE_COUNTER(STAT_WeaponTraceForHits);
+	
+	if (Player == nullptr || Instance == nullptr) return;
+	
+	// One view for every pellet fired this frame
+	const FFireView& View = Player->GetFireView();
+
+	const int32 NumRounds = FMath::Min<int32>(RoundTimes.Num(), (PelletIndexMask + 1) / PelletsPerRound);
+	const int32 NumPellets = NumRounds * PelletsPerRound;
+	PelletDirections.SetNumUninitialized(NumPellets, false);
+	for (int32 Round = 0; Round < NumRounds; ++Round)
 	{
-	case EItemState::EIS_Pickup:
-		// We want to be able to see the mesh, and overlap, but that's it
-		ItemMesh->SetOnlyOwnerSee(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-        ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Overlap);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-		bCanOscillate = true;
-		break;
-	case EItemState::EIS_PickedUp:
-		// No collision, can't see it, etc.
-		ItemMesh->SetOnlyOwnerSee(false);
-		ItemMesh->SetVisibility(false);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		bCanOscillate = false;
-		break;
-		
-	case EItemState::EIS_Equipped:
-		// No shadows, but we can see the mesh and not collide with it
-		ItemMesh->SetOnlyOwnerSee(false);
-		ItemMesh->SetVisibility(true);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->CastShadow = false;
-		ItemMesh->bCastDynamicShadow = false;
-		
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		bCanOscillate = false;
-		break;
-
-	default:
-		// Hide the mesh, disable physics and collision
-		ItemMesh->SetSimulatePhysics(false);
-		ItemMesh->SetEnableGravity(false);
-		ItemMesh->SetVisibility(false);
-		ItemMesh->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		ItemMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		
-		AreaSphere->SetCollisionResponseToAllChannels(ECollisionResponse::ECR_Ignore);
-		AreaSphere->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-		break;
+		// Each round is its own shot, regenerable from the seed and its index alone
+		FWeaponSpread::GeneratePelletDirections(View, Definition->HorizontalSpread, Definition->VerticalSpread,
+												Definition->SpreadPattern, Instance->GetSpreadSeed(), Instance->ConsumeShotIndex(),
+												MakeArrayView(PelletDirections).Slice(Round * PelletsPerRound, PelletsPerRound));
+	}
+
+	FPendingFireBatch& Batch = PendingFireBatches.AddDefaulted_GetRef();
+	Batch.BatchId = NextFireBatchId++;
+	Batch.Definition = Definition;
+	// The tracer sits on the muzzle socket
+	Batch.MuzzleLocation = TracerComponent->GetComponentLocation();
+	Batch.Pellets.SetNum(NumPellets);
+	Batch.OutstandingTraces = Batch.Pellets.Num() * 2;
+	CRAWLINGCHAOS_COUNT_TRACES(Batch.OutstandingTraces);
+
+	const FCollisionQueryParams QueryParams{SCENE_QUERY_STAT(WeaponFire), false, this};
+	for (int32 PelletIndex = 0; PelletIndex < Batch.Pellets.Num(); ++PelletIndex)
+	{
+		FPendingPellet& Pellet = Batch.Pellets[PelletIndex];
+		Pellet.TraceEnd = View.Location + PelletDirections[PelletIndex] * WeaponTraceDistance;
+		Pellet.RoundTime = RoundTimes[PelletIndex / PelletsPerRound];
+
+		// Both traces go out together; the muzzle trace aims at the far end of the camera ray, and anything it
+		// hits before the point the camera sees is in the way of the shot
+		const uint32 UserData = (static_cast<uint32>(Batch.BatchId) << 16) | static_cast<uint32>(PelletIndex);
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, View.Location, Pellet.TraceEnd,
+									   ECollisionChannel::ECC_Visibility, QueryParams,
+									   FCollisionResponseParams::DefaultResponseParam, &PelletTraceDelegate, UserData);
+		World->AsyncLineTraceByChannel(EAsyncTraceType::Single, Batch.MuzzleLocation, Pellet.TraceEnd,
+									   ECollisionChannel::ECC_Visibility, QueryParams,
+									   FCollisionResponseParams::DefaultResponseParam, &PelletTraceDelegate,
+									   UserData | MuzzleTraceFlag);
 	}
 }
 
-// Called every frame
-void AWeapon::Tick(float DeltaTime)
+void AWeapon::OnPelletTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum)
 {
-	Super::Tick(DeltaTime);
+	const uint16 BatchId = static_cast<uint16>(TraceDatum.UserData >> 16);
+	const int32 BatchIndex = PendingFireBatches.IndexOfByPredicate([BatchId](const FPendingFireBatch& Batch)
+	{
+		return Batch.BatchId == BatchId;
+	});
+	if (BatchIndex == INDEX_NONE) return;
+
+	FPendingFireBatch& Batch = PendingFireBatches[BatchIndex];
+	const int32 PelletIndex = TraceDatum.UserData & PelletIndexMask;
+	if (Batch.Pellets.IsValidIndex(PelletIndex) && TraceDatum.OutHits.Num() > 0)
+	{
+		FPendingPellet& Pellet = Batch.Pellets[PelletIndex];
+		FHitResult& Hit = (TraceDatum.UserData & MuzzleTraceFlag) ? Pellet.MuzzleHit : Pellet.CameraHit;
+		Hit = TraceDatum.OutHits[0];
+	}
 
+	if (--Batch.OutstandingTraces <= 0)
+	{
+		const FPendingFireBatch ResolvedBatch{MoveTemp(Batch)};
+		PendingFireBatches.RemoveAtSwap(BatchIndex);
+		ResolveFireBatch(GetWorld(), ResolvedBatch);
+	}
 }
 
-void AWeapon::TraceForHitsAndSpawnAttacks(UWorld* const World) const
+void AWeapon::ResolveFireBatch(UWorld* const World, const FPendingFireBatch& Batch)
 {
-	FVector MuzzleLocation;
-	FRotator ProjectileRotation;
-	const FHitResult HitResult = LineTraceForWeaponFire(World, MuzzleLocation, ProjectileRotation);
+	CRAWLINGCHAOS_SCOPE_CYCLE_COUNTER(STAT_WeaponResolveFireBatch);
+	
+	if (World == nullptr || Batch.Definition == nullptr) return;
+
+	const double Now = World->GetTimeSeconds();
+	for (const FPendingPellet& Pellet : Batch.Pellets)
+	{
+		FVector Location{Pellet.TraceEnd};
+		const FHitResult* ImpactHit = &Pellet.CameraHit;
+		if (Pellet.CameraHit.bBlockingHit)
+		{
+			Location = Pellet.CameraHit.Location;
+		}
+
+		// Something is between the muzzle and what the camera was looking at, so that's what gets hit
+		if (Pellet.MuzzleHit.bBlockingHit &&
+			FVector::DistSquared(Batch.MuzzleLocation, Pellet.MuzzleHit.Location) < FVector::DistSquared(Batch.MuzzleLocation, Location))
+		{
+			Location = Pellet.MuzzleHit.Location;
+			ImpactHit = &Pellet.MuzzleHit;
+		}
+
+		SpawnAttackForPellet(World, *Batch.Definition, Batch.MuzzleLocation, Location, *ImpactHit,
+							 static_cast<float>(Now - Pellet.RoundTime));
+	}
+
+	FlushTracers();
+}
 
-	if (ProjectileClass != nullptr && DamageMode == EDamageMode::EDM_PROJECTILE)
+void AWeapon::SpawnAttackForPellet(UWorld* const World, const FWeaponDataTable& FiredDefinition,
+								   const FVector& MuzzleLocation, const FVector& Location,
+								   const FHitResult& HitResult, const float Age)
+{
+	if (FiredDefinition.Projectile != nullptr && FiredDefinition.DamageMode == EDamageMode::EDM_PROJECTILE)
 	{
-		SpawnProjectile(World, MuzzleLocation, ProjectileRotation, Player);
+		const FRotator ProjectileRotation{UKismetMathLibrary::FindLookAtRotation(MuzzleLocation, Location)};
+
+		// Rounds due earlier than now have already been in flight for a while, so they start further along.
+		// Never past what the pellet was aimed at, or they'd skip through whatever they should hit
+		FVector SpawnLocation{MuzzleLocation};
+		const ACrawlingChaosProjectile* ProjectileDefaults = FiredDefinition.Projectile->GetDefaultObject<ACrawlingChaosProjectile>();
+		const UProjectileMovementComponent* Movement = ProjectileDefaults->GetProjectileMovement();
+		if (Movement != nullptr && Age > 0.f)
+		{
+			const float MaxAdvance = FMath::Max(FVector::Dist(MuzzleLocation, Location) - ProjectileDefaults->GetCollisionComp()->GetScaledSphereRadius(), 0.f);
+			SpawnLocation += ProjectileRotation.Vector() * FMath::Min(Movement->InitialSpeed * Age, MaxAdvance);
+		}
+		SpawnProjectile(World, FiredDefinition, SpawnLocation, ProjectileRotation, Player);
 	}
 	else
 	{
 		// todo: add surface specific effects here
+		// The effects are cosmetic and may not have streamed in yet; the hit lands either way
+		UNiagaraSystem* HitParticleSystem = FiredDefinition.HitParticleSystem.Get();
 		if (HitResult.bBlockingHit && HitParticleSystem)
 		{
 			// todo: spawn a projectile that the tracer particle is attached to, so you can see the bullet
-			UNiagaraFunctionLibrary::SpawnSystemAtLocation(GetWorld(), HitParticleSystem, HitResult.Location);
+			if (UImpactEffectSubsystem* ImpactEffects = World->GetSubsystem<UImpactEffectSubsystem>())
+			{
+				ImpactEffects->QueueImpact(HitParticleSystem, HitResult.Location, HitResult.ImpactNormal);
+			}
 			
-			if (TracerParticleSystem != nullptr)
+			if (TracerComponent->GetAsset() != nullptr)
 			{
 				const bool bShouldSpawnTracer = FMath::RandRange(0, 3) == 2;
 				if (bShouldSpawnTracer)
@@ -231,144 +423,185 @@ void AWeapon::TraceForHitsAndSpawnAttacks(UWorld* const World) const
 					const float TracerSpawnMultiplier = FMath::RandRange(30, 400);
 					const FVector Start{MuzzleLocation + BulletDirection*TracerSpawnMultiplier};
 					const FVector End{MuzzleLocation + BulletDirection*(TracerSpawnMultiplier + 150)};
-				
-					const auto Tracer = UNiagaraFunctionLibrary::SpawnSystemAtLocation(GetWorld(), TracerParticleSystem, Start);
-					Tracer->SetNiagaraVariableVec3(FString{"BeamEnd"}, End);
+
+					// Beams only live for the frame they were fired in
+					if (TracerBeamFrame != GFrameCounter)
+					{
+						TracerBeamStarts.Reset();
+						TracerBeamEnds.Reset();
+						TracerBeamFrame = GFrameCounter;
+					}
+					TracerBeamStarts.Add(Start);
+					TracerBeamEnds.Add(End);
+					INC_DWORD_STAT(STAT_EffectsSpawned);
 				}
 			}
-			if (HitResult.GetActor()) 
+		}
+
+		if (HitResult.bBlockingHit)
+		{
+			const FVector ShotDirection{(HitResult.TraceEnd - HitResult.TraceStart).GetSafeNormal()};
+
+			// Every pellet that lands on an actor this frame reaches it as one damage event
+			if (UDamageQueueSubsystem* DamageQueue = World->GetSubsystem<UDamageQueueSubsystem>())
 			{
-				if(HitResult.GetActor()->IsRootComponentMovable()) {
-					const FVector CameraForward{Player->GetActorForwardVector()};
-					UStaticMeshComponent* MeshRootComp = Cast<UStaticMeshComponent>(HitResult.GetActor()->GetRootComponent());
+				DamageQueue->QueueDamage(HitResult.GetActor(), FiredDefinition.Damage, HitResult, ShotDirection,
+										 Player ? Player->GetController() : nullptr, this, UDamageType::StaticClass());
+			}
 
-					
-					MeshRootComp->AddForceAtLocation(CameraForward*25000*MeshRootComp->GetMass(), HitResult.Location);
+			// Push whatever body was hit; every pellet on it this frame lands in one physics write
+			UPrimitiveComponent* HitComponent = HitResult.GetComponent();
+			if (HitComponent && HitComponent->IsSimulatingPhysics(HitResult.BoneName))
+			{
+				if (UImpulseAccumulatorSubsystem* Impulses = World->GetSubsystem<UImpulseAccumulatorSubsystem>())
+				{
+					const FVector Impulse{ShotDirection * PelletImpulsePerUnitMass * HitComponent->GetMass()};
+					Impulses->AddImpulseAtLocation(HitComponent, HitResult.BoneName, Impulse, HitResult.Location);
 				}
 			}
 		}
 	}
 }
 
-void AWeapon::OnFire()
+void AWeapon::FlushTracers()
 {
-	if (!bStartFiring || !bCanFire) return;
-	if (ItemState != EItemState::EIS_Equipped) return; // sanity check
-	if (Player == nullptr) return;
-	if (Player->GetAmmo(AmmoType) <= 0) return;
-	
-	UWorld* const World = GetWorld();
-	if (World != nullptr)
+	if (TracerBeamFrame != GFrameCounter)
 	{
-		// Set this to false, it'll only reset if the timer pops. Prevents the player from doing annoying
-		// cheese like scroll-wheel shooting
-		bCanFire = false;
+		TracerBeamStarts.Reset();
+		TracerBeamEnds.Reset();
+	}
+	if (TracerBeamStarts.Num() == 0 && !bTracerBeamsPending) return;
+	
+	// The system spawns a beam for every entry each frame, so whatever we hand it now is cleared again next tick.
+	// Several batches resolving in the same frame each push everything fired so far this frame
+	UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector(TracerComponent, TracerBeamStartsParameter, TracerBeamStarts);
+	UNiagaraDataInterfaceArrayFunctionLibrary::SetNiagaraArrayVector(TracerComponent, TracerBeamEndsParameter, TracerBeamEnds);
 
-		size_t i = 0;
-		do
+	bTracerBeamsPending = TracerBeamStarts.Num() > 0;
+	if (bTracerBeamsPending)
+	{
+		if (!TracerComponent->IsActive())
 		{
-			TraceForHitsAndSpawnAttacks(World);
-			i++;
-		} while (i < NumberOfShots);
-		
+			TracerComponent->Activate();
+		}
+		GetWorldTimerManager().SetTimerForNextTick(this, &AWeapon::FlushTracers);
+	}
+}
 
-		Player->DecrementInventoryValue(AmmoType, NumberOfShots);
+void AWeapon::PullTrigger()
+{
+	UWorld* const World = GetWorld();
+	if (World == nullptr || Instance == nullptr) return;
 
-		// try and play the sound if specified
-		if (FireSound != nullptr)
-		{
-			UGameplayStatics::PlaySoundAtLocation(this, FireSound, GetActorLocation());
-		}
+	// Stamp the pull with the time it arrived rather than waiting on the next tick, so the first round goes
+	// out on this frame
+	Instance->GetFireScheduler().PullTrigger(World->GetTimeSeconds(), Definition->FireMode, Definition->NumberOfShots);
+	FireDueRounds();
+}
 
-		// try and play a firing animation if specified
-		if (FireAnimation != nullptr)
-		{
-			// Get the animation object for the arms mesh
-			Player->PlayWeaponFireAnimation(FireAnimation);
-		}
+void AWeapon::ReleaseTrigger()
+{
+	if (Instance == nullptr) return;
+	Instance->GetFireScheduler().ReleaseTrigger();
+}
 
-		// Timer for automatic fire and/rate of fire enforcement
-		GetWorld()->GetTimerManager().SetTimer(WeaponFireTimer,
-			this,
-			&AWeapon::AutoFireReset,
-			GetRateOfFire());
+void AWeapon::StopFiring()
+{
+	if (Instance != nullptr)
+	{
+		Instance->GetFireScheduler().Reset();
+	}
+	SetActorTickEnabled(false);
+
+	// Ends a fire loop right away instead of waiting for it to time out
+	UWorld* const World = GetWorld();
+	if (UWeaponAudioSubsystem* WeaponAudio = World ? World->GetSubsystem<UWeaponAudioSubsystem>() : nullptr)
+	{
+		WeaponAudio->StopFire(this);
 	}
 }
 
-FHitResult AWeapon::LineTraceForWeaponFire(const UWorld* World, FVector& MuzzleLocation, FRotator& ProjectileRotation) const
+void AWeapon::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	FireDueRounds();
+}
+
+void AWeapon::FireDueRounds()
 {
-	MuzzleLocation = ItemMesh->GetSocketLocation("Muzzle");
-	FVector2D ViewPort;
-	if (GEngine && GEngine->GameViewport)
+	UWorld* const World = GetWorld();
+	if (World == nullptr || ItemState != EItemState::EIS_Equipped || Player == nullptr || Instance == nullptr)
 	{
-		GEngine->GameViewport->GetViewportSize(ViewPort);
+		StopFiring();
+		return;
 	}
 
-	// Get our screen center in world coordinates
-	float spreadX = FMath::RandRange(-HorizontalSpread, HorizontalSpread);
-	float spreadY = FMath::RandRange(-VerticalSpread, VerticalSpread);
-	const FVector2D ScreenCenter{ (ViewPort.X / 2) + spreadX, (ViewPort.Y / 2) + spreadY };
-	FVector WorldPosition;
-	FVector WorldDirection;
-	const bool bScreenToWorld = UGameplayStatics::DeprojectScreenToWorld(UGameplayStatics::GetPlayerController(this, 0),
-											 ScreenCenter, WorldPosition, WorldDirection);
-	if (bScreenToWorld)
+	// Every round due since the last frame goes out now, however many the frame time covers
+	FWeaponFireScheduler& FireScheduler = Instance->GetFireScheduler();
+	DueRoundTimes.Reset();
+	const int32 Ammo = Player->GetAmmo(Definition->AmmoType);
+	FireScheduler.CollectDueRounds(World->GetTimeSeconds(), GetRateOfFire(), Ammo, DueRoundTimes);
+	if (DueRoundTimes.Num() > 0)
 	{
-		// Start from the center in world coordinates and go out by 50'000
-		const FVector TraceStart{WorldPosition};
-		const FVector TraceEnd{WorldPosition + (WorldDirection * (50'000))};
-		FVector Location = TraceEnd;
-		FHitResult HitResult;
-
-		// See if our line trace finds a hit
-		World->LineTraceSingleByChannel(HitResult, TraceStart, TraceEnd,
-										ECollisionChannel::ECC_Visibility);
-		if (HitResult.bBlockingHit)
+		OnFire(DueRoundTimes);
+	}
+
+	// Only keep ticking while there's more to fire
+	SetActorTickEnabled(FireScheduler.IsActive());
+}
+
+void AWeapon::OnFire(const TArray<double>& RoundTimes)
+{
+	CRAWLINGCHAOS_SCOPE_CYCLE_COUNTER(STAT_WeaponOnFire);
+	INC_DWORD_STAT_BY(STAT_ShotsFired, RoundTimes.Num());
+	
+	UWorld* const World = GetWorld();
+	if (World != nullptr)
+	{
+		// Burst weapons fire their shots as separate rounds, everything else fires them as pellets of each round
+		const int32 PelletsPerRound = Definition->FireMode == EFireMode::EFM_Burst ? 1 : FMath::Max(Definition->NumberOfShots, 1);
+
+		// Every pellet of these rounds is traced asynchronously and resolved next frame
+		TraceForHitsAndSpawnAttacks(World, RoundTimes, PelletsPerRound);
+
+		Player->DecrementInventoryValue(Definition->AmmoType, RoundTimes.Num());
+
+		// One sound for the frame's rounds, or the fire loop for fast full-auto weapons
+		if (UWeaponAudioSubsystem* WeaponAudio = World->GetSubsystem<UWeaponAudioSubsystem>())
 		{
-			Location = HitResult.Location;
+			WeaponAudio->PlayFire(this, *Definition);
 		}
 
-		// Now see if anything is in the way of the trace when it's from muzzle to the original hit
-		FHitResult MuzzleTraceHit;
-		const FVector TraceEndWithMuzzleLength{ Location - MuzzleLocation };
-		const FVector MuzzleToEnd{ MuzzleLocation + TraceEndWithMuzzleLength * 1.25f };
-		World->LineTraceSingleByChannel(MuzzleTraceHit, MuzzleLocation,
-										MuzzleToEnd, ECollisionChannel::ECC_Visibility);
-		if (MuzzleTraceHit.bBlockingHit)
+		// try and play a firing animation if specified
+		if (UAnimMontage* Animation = GetFireAnimation())
 		{
-			Location = MuzzleTraceHit.Location;
+			// Get the animation object for the arms mesh
+			Player->PlayWeaponFireAnimation(Animation);
 		}
-
-		ProjectileRotation = UKismetMathLibrary::FindLookAtRotation(MuzzleLocation, Location);
-		return MuzzleTraceHit;
 	}
-	// Return an empty hit result
-	return FHitResult{};
 }
 
-void AWeapon::SpawnProjectile(UWorld* const World, const FVector MuzzleLocation, const FRotator ProjectileRotation, ACrawlingChaosCharacter* Character) const
+void AWeapon::SpawnProjectile(UWorld* const World, const FWeaponDataTable& FiredDefinition, const FVector MuzzleLocation,
+							  const FRotator ProjectileRotation, ACrawlingChaosCharacter* Character) const
 {
-	// Set Spawn Collision Handling Override
-	FActorSpawnParameters ActorSpawnParams;
-	ActorSpawnParams.SpawnCollisionHandlingOverride =
-		ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-	ActorSpawnParams.Owner = Character;
-			
-	// Spawn the projectile at the muzzle
-	const auto Projectile = World->SpawnActor<ACrawlingChaosProjectile>(ProjectileClass, MuzzleLocation, ProjectileRotation,
-																	ActorSpawnParams);
-
-	if (Character)
+	CRAWLINGCHAOS_SCOPE_CYCLE_COUNTER(STAT_WeaponSpawnProjectile);
+	
+	// Projectiles without gameplay callbacks don't need an actor at all
+	UProjectileManagerSubsystem* ProjectileManager = World->GetSubsystem<UProjectileManagerSubsystem>();
+	if (ProjectileManager && ProjectileManager->SpawnProjectile(FiredDefinition.Projectile, MuzzleLocation, ProjectileRotation, Character))
 	{
-		Character->GetCapsuleComponent()->IgnoreActorWhenMoving(Projectile, true);
+		return;
 	}
-}
+	
+	UProjectilePoolSubsystem* ProjectilePool = World->GetSubsystem<UProjectilePoolSubsystem>();
+	if (ProjectilePool == nullptr) return;
+	
+	// Launch a pooled projectile from the muzzle
+	const auto Projectile = ProjectilePool->Acquire(FiredDefinition.Projectile, MuzzleLocation, ProjectileRotation, Character);
 
-void AWeapon::AutoFireReset()
-{
-	bCanFire = true;
-	if (bStartFiring && FireMode == EFireMode::EFM_FullAuto && Player->GetAmmo(AmmoType) > 0)
+	if (Character && Projectile)
 	{
-		OnFire();
+		Character->GetCapsuleComponent()->IgnoreActorWhenMoving(Projectile, true);
 	}
 }
@@ -0,0 +1,167 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponAssetSubsystem.h"
+
+#include "PickupSubsystem.h"
+#include "Weapon.h"
+#include "WeaponDefinitionSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+
+UWeaponAssetSubsystem::UWeaponAssetSubsystem() :
+	RelevanceRange(4000.f),
+	ReleaseRangeScale(1.25f),
+	RelevanceUpdateInterval(0.25f),
+	TimeSinceRelevanceUpdate(0.f)
+{
+}
+
+void UWeaponAssetSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Slots.SetNum(static_cast<int32>(EWeaponType::EWT_DefaultMAX));
+
+	// Check on the first tick rather than waiting an interval, so pickups placed near the player don't pop in
+	TimeSinceRelevanceUpdate = RelevanceUpdateInterval;
+}
+
+void UWeaponAssetSubsystem::Deinitialize()
+{
+	for (FWeaponAssetSlot& Slot : Slots)
+	{
+		if (Slot.Handle.IsValid())
+		{
+			Slot.Handle->CancelHandle();
+		}
+	}
+	Slots.Reset();
+	
+	Super::Deinitialize();
+}
+
+bool UWeaponAssetSubsystem::IsTickable() const
+{
+	// Only pickups ever come in and out of range; pins are handled as they happen. Keep going while any type is
+	// still relevant too, so the last pickup of a type being collected still lets its assets go
+	const UPickupSubsystem* Pickups = GetWorld()->GetSubsystem<UPickupSubsystem>();
+	if (Pickups && Pickups->GetNumPickups() > 0) return true;
+	
+	return Slots.ContainsByPredicate([](const FWeaponAssetSlot& Slot)
+	{
+		return Slot.bRelevant;
+	});
+}
+
+TStatId UWeaponAssetSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UWeaponAssetSubsystem, STATGROUP_Tickables);
+}
+
+void UWeaponAssetSubsystem::PinWeapon(const EWeaponType WeaponType)
+{
+	if (!Slots.IsValidIndex(static_cast<int32>(WeaponType))) return;
+	
+	++Slots[static_cast<int32>(WeaponType)].PinCount;
+	UpdateStreaming(WeaponType);
+}
+
+void UWeaponAssetSubsystem::UnpinWeapon(const EWeaponType WeaponType)
+{
+	if (!Slots.IsValidIndex(static_cast<int32>(WeaponType))) return;
+
+	FWeaponAssetSlot& Slot = Slots[static_cast<int32>(WeaponType)];
+	Slot.PinCount = FMath::Max(Slot.PinCount - 1, 0);
+	UpdateStreaming(WeaponType);
+}
+
+bool UWeaponAssetSubsystem::AreAssetsLoaded(const EWeaponType WeaponType) const
+{
+	const int32 Index = static_cast<int32>(WeaponType);
+	return Slots.IsValidIndex(Index) && Slots[Index].Handle.IsValid() && Slots[Index].Handle->HasLoadCompleted();
+}
+
+// Called every frame while there are pickups to watch or relevant types to let go of
+void UWeaponAssetSubsystem::Tick(float DeltaTime)
+{
+	TimeSinceRelevanceUpdate += DeltaTime;
+	if (TimeSinceRelevanceUpdate < RelevanceUpdateInterval) return;
+
+	TimeSinceRelevanceUpdate = 0.f;
+	UpdateRelevance();
+}
+
+void UWeaponAssetSubsystem::UpdateRelevance()
+{
+	const APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	const UPickupSubsystem* Pickups = GetWorld()->GetSubsystem<UPickupSubsystem>();
+	if (PlayerController == nullptr || Pickups == nullptr) return;
+
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	PlayerController->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+	TArray<bool, TInlineAllocator<8>> bInRange;
+	TArray<bool, TInlineAllocator<8>> bInReleaseRange;
+	bInRange.SetNumZeroed(Slots.Num());
+	bInReleaseRange.SetNumZeroed(Slots.Num());
+	
+	// Only the cells within the release range are visited
+	const float ReleaseRange = RelevanceRange * ReleaseRangeScale;
+	TArray<AItem*> NearbyItems;
+	Pickups->QueryPickups(ViewLocation, ReleaseRange, NearbyItems);
+
+	const float RangeSquared = FMath::Square(RelevanceRange);
+	const float ReleaseRangeSquared = FMath::Square(ReleaseRange);
+	for (const AItem* Item : NearbyItems)
+	{
+		const AWeapon* Pickup = Cast<AWeapon>(Item);
+		if (Pickup == nullptr) continue;
+
+		const int32 TypeIndex = static_cast<int32>(Pickup->GetWeaponType());
+		if (!Slots.IsValidIndex(TypeIndex)) continue;
+		
+		const float DistanceSquared = FVector::DistSquared(ViewLocation, Pickup->GetActorLocation());
+		bInRange[TypeIndex] |= DistanceSquared <= RangeSquared;
+		bInReleaseRange[TypeIndex] |= DistanceSquared <= ReleaseRangeSquared;
+	}
+
+	for (int32 TypeIndex = 0; TypeIndex < Slots.Num(); ++TypeIndex)
+	{
+		FWeaponAssetSlot& Slot = Slots[TypeIndex];
+		const bool bRelevant = Slot.bRelevant ? bInReleaseRange[TypeIndex] : bInRange[TypeIndex];
+		if (bRelevant == Slot.bRelevant) continue;
+
+		Slot.bRelevant = bRelevant;
+		UpdateStreaming(static_cast<EWeaponType>(TypeIndex));
+	}
+}
+
+void UWeaponAssetSubsystem::UpdateStreaming(const EWeaponType WeaponType)
+{
+	FWeaponAssetSlot& Slot = Slots[static_cast<int32>(WeaponType)];
+	const bool bWanted = Slot.PinCount > 0 || Slot.bRelevant;
+	if (bWanted == Slot.Handle.IsValid()) return;
+
+	if (!bWanted)
+	{
+		// Nothing else holds the assets, so the next garbage collection can take them
+		Slot.Handle->ReleaseHandle();
+		Slot.Handle.Reset();
+		return;
+	}
+
+	TArray<FSoftObjectPath> Assets;
+	UWeaponDefinitionSubsystem::FindDefinition(WeaponType)->GetStreamedAssets(Assets);
+	if (Assets.Num() == 0) return;
+	
+	Slot.Handle = StreamableManager.RequestAsyncLoad(Assets,
+		FStreamableDelegate::CreateUObject(this, &UWeaponAssetSubsystem::OnAssetsStreamed, WeaponType),
+		FStreamableManager::AsyncLoadHighPriority);
+}
+
+void UWeaponAssetSubsystem::OnAssetsStreamed(const EWeaponType WeaponType)
+{
+	OnWeaponAssetsLoaded.Broadcast(WeaponType);
+}
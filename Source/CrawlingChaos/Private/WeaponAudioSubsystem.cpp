@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponAudioSubsystem.h"
+
+#include "Weapon.h"
+#include "Components/AudioComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/WorldSettings.h"
+#include "Sound/SoundBase.h"
+
+UWeaponAudioSubsystem::UWeaponAudioSubsystem() :
+	OneShotPoolSize(16),
+	MaxVoicesPerWeaponType(4),
+	LoopTimeoutRounds(1.5f),
+	LoopFadeOutTime(0.05f),
+	NumDroppedSounds(0)
+{
+}
+
+void UWeaponAudioSubsystem::Deinitialize()
+{
+	for (const FWeaponOneShot& OneShot : OneShots)
+	{
+		if (IsValid(OneShot.Component))
+		{
+			OneShot.Component->DestroyComponent();
+		}
+	}
+	OneShots.Reset();
+
+	// Loop components belong to their weapons and go with them
+	Loops.Reset();
+	
+	Super::Deinitialize();
+}
+
+bool UWeaponAudioSubsystem::IsTickable() const
+{
+	return Loops.ContainsByPredicate([](const FWeaponFireLoop& Loop) { return Loop.bPlaying; });
+}
+
+TStatId UWeaponAudioSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UWeaponAudioSubsystem, STATGROUP_Tickables);
+}
+
+// Called every frame while a fire loop is playing
+void UWeaponAudioSubsystem::Tick(float DeltaTime)
+{
+	// Weapons that stopped getting rounds out (trigger released, out of ammo) end their loop here
+	const double Now = GetWorld()->GetTimeSeconds();
+	for (int32 Index = Loops.Num() - 1; Index >= 0; --Index)
+	{
+		FWeaponFireLoop& Loop = Loops[Index];
+		if (!Loop.Source.IsValid() || !IsValid(Loop.Component))
+		{
+			Loops.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		if (Loop.bPlaying && Now - Loop.LastRoundTime > Loop.Timeout)
+		{
+			EndLoop(Loop);
+		}
+	}
+}
+
+void UWeaponAudioSubsystem::PlayFire(AActor* Source, const FWeaponDataTable& Definition)
+{
+	if (Source == nullptr) return;
+
+	USoundBase* LoopSound = Definition.FireLoopSound.Get();
+	const bool bLoops = LoopSound && Definition.FireMode == EFireMode::EFM_FullAuto &&
+		Definition.LoopFireRateThreshold > 0.f && Definition.AutoFireRate >= Definition.LoopFireRateThreshold;
+	if (bLoops)
+	{
+		KeepLoopPlaying(Source, Definition, LoopSound);
+		return;
+	}
+
+	// Rounds fired in the same frame would land on top of each other, so they share a single sound
+	PlayOneShot(Definition.FireSound.Get(), Source->GetActorLocation(), Definition.WeaponType);
+}
+
+void UWeaponAudioSubsystem::StopFire(AActor* Source)
+{
+	FWeaponFireLoop* Loop = Loops.FindByPredicate([Source](const FWeaponFireLoop& Candidate)
+	{
+		return Candidate.Source == Source;
+	});
+	if (Loop && Loop->bPlaying)
+	{
+		EndLoop(*Loop);
+	}
+}
+
+bool UWeaponAudioSubsystem::KeepLoopPlaying(AActor* Source, const FWeaponDataTable& Definition, USoundBase* LoopSound)
+{
+	FWeaponFireLoop* Loop = Loops.FindByPredicate([Source](const FWeaponFireLoop& Candidate)
+	{
+		return Candidate.Source == Source;
+	});
+	
+	if (Loop == nullptr)
+	{
+		UAudioComponent* Component = NewObject<UAudioComponent>(Source);
+		Component->bAutoActivate = false;
+		Component->bAutoDestroy = false;
+		Component->SetupAttachment(Source->GetRootComponent());
+		Component->RegisterComponent();
+		
+		Loop = &Loops.AddDefaulted_GetRef();
+		Loop->Source = Source;
+		Loop->Component = Component;
+	}
+
+	const double Now = GetWorld()->GetTimeSeconds();
+	Loop->LastRoundTime = Now;
+	Loop->Timeout = LoopTimeoutRounds * 60.0 / Definition.AutoFireRate;
+	if (Loop->bPlaying && Loop->WeaponType == Definition.WeaponType) return true;
+	
+	// The weapon actor in hand changes type on swap, so make sure the loop matches what it's firing now
+	if (Loop->bPlaying)
+	{
+		EndLoop(*Loop);
+	}
+	if (CountVoices(Definition.WeaponType) >= MaxVoicesPerWeaponType)
+	{
+		++NumDroppedSounds;
+		return false;
+	}
+
+	Loop->WeaponType = Definition.WeaponType;
+	Loop->TailSound = Definition.FireTailSound.Get();
+	Loop->Component->SetSound(LoopSound);
+	Loop->Component->Play();
+	Loop->bPlaying = true;
+	return true;
+}
+
+void UWeaponAudioSubsystem::EndLoop(FWeaponFireLoop& Loop)
+{
+	Loop.bPlaying = false;
+	Loop.Component->FadeOut(LoopFadeOutTime, 0.f);
+
+	// The tail takes over the loop's voice, so it's never refused
+	if (Loop.TailSound && Loop.Source.IsValid())
+	{
+		PlayOneShot(Loop.TailSound, Loop.Source->GetActorLocation(), Loop.WeaponType, false);
+	}
+}
+
+void UWeaponAudioSubsystem::PlayOneShot(USoundBase* Sound, const FVector& Location, const EWeaponType WeaponType,
+										 const bool bLimitVoices)
+{
+	if (Sound == nullptr) return;
+
+	if (bLimitVoices && CountVoices(WeaponType) >= MaxVoicesPerWeaponType)
+	{
+		++NumDroppedSounds;
+		return;
+	}
+
+	// Reuse a finished component, or grow the pool while there's room
+	FWeaponOneShot* OneShot = OneShots.FindByPredicate([](const FWeaponOneShot& Candidate)
+	{
+		return IsValid(Candidate.Component) && !Candidate.Component->IsPlaying();
+	});
+	if (OneShot == nullptr && OneShots.Num() < OneShotPoolSize)
+	{
+		UAudioComponent* Component = NewObject<UAudioComponent>(GetWorld()->GetWorldSettings());
+		Component->bAutoActivate = false;
+		Component->bAutoDestroy = false;
+		Component->RegisterComponentWithWorld(GetWorld());
+
+		OneShot = &OneShots.AddDefaulted_GetRef();
+		OneShot->Component = Component;
+	}
+	if (OneShot == nullptr)
+	{
+		++NumDroppedSounds;
+		return;
+	}
+
+	OneShot->WeaponType = WeaponType;
+	OneShot->Component->SetWorldLocation(Location);
+	OneShot->Component->SetSound(Sound);
+	OneShot->Component->Play();
+}
+
+int32 UWeaponAudioSubsystem::CountVoices(const EWeaponType WeaponType) const
+{
+	int32 NumVoices = 0;
+	for (const FWeaponOneShot& OneShot : OneShots)
+	{
+		NumVoices += OneShot.WeaponType == WeaponType && IsValid(OneShot.Component) && OneShot.Component->IsPlaying();
+	}
+	for (const FWeaponFireLoop& Loop : Loops)
+	{
+		NumVoices += Loop.WeaponType == WeaponType && Loop.bPlaying;
+	}
+	return NumVoices;
+}
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponDefinitionSubsystem.h"
+
+#include "Engine/DataTable.h"
+#include "Engine/Engine.h"
+
+namespace
+{
+	/** Path of the weapon data table asset */
+	const TCHAR* WeaponTablePath{TEXT("DataTable'/Game/_Game/Weapons/DataTables/WeaponDataTable.WeaponDataTable'")};
+
+	/** Data table row for each weapon type, in EWeaponType order */
+	const TCHAR* WeaponRowNames[] =
+	{
+		TEXT("Shotgun"),
+		TEXT("RocketLauncher"),
+		TEXT("Rifle"),
+		TEXT("PlasmaGun"),
+	};
+	static_assert(UE_ARRAY_COUNT(WeaponRowNames) == static_cast<int32>(EWeaponType::EWT_DefaultMAX),
+				  "Every weapon type needs a row name");
+}
+
+void UWeaponDefinitionSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Sized once up front; weapons keep pointers into this array
+	Definitions.SetNum(static_cast<int32>(EWeaponType::EWT_DefaultMAX));
+}
+
+void UWeaponDefinitionSubsystem::Deinitialize()
+{
+	if (WeaponTable)
+	{
+		WeaponTable->OnDataTableChanged().RemoveAll(this);
+		WeaponTable = nullptr;
+	}
+	
+	Super::Deinitialize();
+}
+
+const FWeaponDataTable* UWeaponDefinitionSubsystem::GetDefinition(const EWeaponType WeaponType)
+{
+	const int32 Index = static_cast<int32>(WeaponType);
+	if (!Definitions.IsValidIndex(Index))
+	{
+		return &GetEmptyDefinition();
+	}
+
+	LoadDefinitions();
+	return &Definitions[Index];
+}
+
+const FWeaponDataTable* UWeaponDefinitionSubsystem::FindDefinition(const EWeaponType WeaponType)
+{
+	if (GEngine)
+	{
+		if (UWeaponDefinitionSubsystem* Subsystem = GEngine->GetEngineSubsystem<UWeaponDefinitionSubsystem>())
+		{
+			return Subsystem->GetDefinition(WeaponType);
+		}
+	}
+	return &GetEmptyDefinition();
+}
+
+const FWeaponDataTable& UWeaponDefinitionSubsystem::GetEmptyDefinition()
+{
+	static const FWeaponDataTable EmptyDefinition;
+	return EmptyDefinition;
+}
+
+void UWeaponDefinitionSubsystem::LoadDefinitions()
+{
+	if (WeaponTable) return;
+	
+	WeaponTable = Cast<UDataTable>(StaticLoadObject(UDataTable::StaticClass(), nullptr, WeaponTablePath));
+	if (WeaponTable)
+	{
+		// Keep the definitions in sync when the table is edited or reimported
+		WeaponTable->OnDataTableChanged().AddUObject(this, &UWeaponDefinitionSubsystem::ResolveDefinitions);
+		ResolveDefinitions();
+	}
+}
+
+void UWeaponDefinitionSubsystem::ResolveDefinitions()
+{
+	for (int32 Index = 0; Index < Definitions.Num(); ++Index)
+	{
+		const FWeaponDataTable* Row = WeaponTable->FindRow<FWeaponDataTable>(FName(WeaponRowNames[Index]),
+																			TEXT("UWeaponDefinitionSubsystem"));
+		Definitions[Index] = Row ? *Row : FWeaponDataTable{};
+	}
+}
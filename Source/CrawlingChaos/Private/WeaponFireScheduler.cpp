@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponFireScheduler.h"
+
+void FWeaponFireScheduler::PullTrigger(const double Time, const EFireMode FireMode, const int32 BurstLength)
+{
+	const bool bCoolingDown = Time < NextRoundTime;
+	switch (FireMode)
+	{
+	case EFireMode::EFM_FullAuto:
+		// Held full-auto keeps going; if we're still cooling down the first round waits for it
+		RoundsRemaining = -1;
+		break;
+	case EFireMode::EFM_Burst:
+		// Prevents the player from doing annoying cheese like scroll-wheel shooting
+		if (bCoolingDown || IsActive()) return;
+		RoundsRemaining = FMath::Max(BurstLength, 1);
+		break;
+	default:
+		if (bCoolingDown || IsActive()) return;
+		RoundsRemaining = 1;
+		break;
+	}
+
+	// An idle weapon fires right on the trigger pull rather than catching up on rounds it didn't fire
+	NextRoundTime = FMath::Max(NextRoundTime, Time);
+}
+
+void FWeaponFireScheduler::ReleaseTrigger()
+{
+	if (RoundsRemaining < 0)
+	{
+		RoundsRemaining = 0;
+	}
+}
+
+void FWeaponFireScheduler::Reset()
+{
+	RoundsRemaining = 0;
+}
+
+void FWeaponFireScheduler::CollectDueRounds(const double Now, const double SecondsPerRound, const int32 MaxRounds,
+											TArray<double>& OutRoundTimes)
+{
+	// Held full-auto with no rate would never run out of due rounds
+	const double RoundInterval = FMath::Max(SecondsPerRound, 0.0);
+	if (RoundInterval == 0.0 && RoundsRemaining < 0)
+	{
+		Reset();
+		return;
+	}
+	
+	int32 NumCollected = 0;
+	while (RoundsRemaining != 0 && NextRoundTime <= Now)
+	{
+		if (NumCollected >= MaxRounds)
+		{
+			Reset();
+			break;
+		}
+		
+		OutRoundTimes.Add(NextRoundTime);
+		NextRoundTime += RoundInterval;
+		++NumCollected;
+		if (RoundsRemaining > 0)
+		{
+			--RoundsRemaining;
+		}
+	}
+}
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponInstance.h"
+
+#include "WeaponDefinitionSubsystem.h"
+
+UWeaponInstance::UWeaponInstance() :
+	WeaponType(EWeaponType::EWT_Shotgun),
+	SpreadSeed(0),
+	ShotIndex(0),
+	Definition(&UWeaponDefinitionSubsystem::GetEmptyDefinition())
+{
+}
+
+void UWeaponInstance::Initialize(const EWeaponType NewWeaponType)
+{
+	WeaponType = NewWeaponType;
+	Definition = UWeaponDefinitionSubsystem::FindDefinition(WeaponType);
+	SpreadSeed = static_cast<uint32>(FMath::Rand());
+	ShotIndex = 0;
+	FireScheduler.Reset();
+}
@@ -0,0 +1,163 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponPrewarmSubsystem.h"
+
+#include "../CrawlingChaosCharacter.h"
+#include "EngineUtils.h"
+#include "ImpactEffectSubsystem.h"
+#include "NiagaraComponent.h"
+#include "NiagaraFunctionLibrary.h"
+#include "NiagaraSystem.h"
+#include "ProjectileManagerSubsystem.h"
+#include "ProjectilePoolSubsystem.h"
+#include "Weapon.h"
+#include "WeaponDefinitionSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "Kismet/GameplayStatics.h"
+#include "Particles/ParticleSystem.h"
+#include "Particles/ParticleSystemComponent.h"
+#include "Sound/SoundBase.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogWeaponPrewarm, Log, All);
+
+namespace
+{
+	/** Far below anything playable, so warm-up effects are never seen */
+	const FVector PrewarmLocation{0.f, 0.f, -100000.f};
+
+	/** Run the work and log how long it took against the asset it was for */
+	void TimePrewarm(const TCHAR* Stage, const UObject* Asset, TFunctionRef<void()> Work)
+	{
+		if (Asset == nullptr) return;
+
+		const double StartTime = FPlatformTime::Seconds();
+		Work();
+		UE_LOG(LogWeaponPrewarm, Log, TEXT("%s %s: %.2f ms"), Stage, *Asset->GetName(),
+			   (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+}
+
+UWeaponPrewarmSubsystem::UWeaponPrewarmSubsystem() :
+	EffectPrewarmTicks(4),
+	EffectPrewarmTickDelta(1.f / 30.f),
+	ImpactPoolPrewarmCount(4)
+{
+}
+
+void UWeaponPrewarmSubsystem::OnWorldBeginPlay(UWorld& InWorld)
+{
+	Super::OnWorldBeginPlay(InWorld);
+
+	if (!InWorld.IsGameWorld()) return;
+
+	TArray<EWeaponType> WeaponTypes;
+	GatherWeaponTypes(InWorld, WeaponTypes);
+
+	const double StartTime = FPlatformTime::Seconds();
+	for (const EWeaponType WeaponType : WeaponTypes)
+	{
+		PrewarmWeapon(InWorld, WeaponType);
+	}
+	UE_LOG(LogWeaponPrewarm, Log, TEXT("Prewarmed %d weapon types in %.2f ms"), WeaponTypes.Num(),
+		   (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+void UWeaponPrewarmSubsystem::GatherWeaponTypes(UWorld& InWorld, TArray<EWeaponType>& OutWeaponTypes) const
+{
+	for (TActorIterator<AWeapon> It(&InWorld); It; ++It)
+	{
+		OutWeaponTypes.AddUnique(It->GetWeaponType());
+	}
+
+	// The player's pawn hasn't spawned yet, so go through the class it will spawn as
+	const AGameModeBase* GameMode = InWorld.GetAuthGameMode();
+	const UClass* PawnClass = GameMode ? GameMode->DefaultPawnClass.Get() : nullptr;
+	const ACrawlingChaosCharacter* Character = PawnClass ? Cast<ACrawlingChaosCharacter>(PawnClass->GetDefaultObject()) : nullptr;
+	if (Character && Character->GetDefaultWeaponClass())
+	{
+		OutWeaponTypes.AddUnique(Character->GetDefaultWeaponClass()->GetDefaultObject<AWeapon>()->GetWeaponType());
+	}
+}
+
+void UWeaponPrewarmSubsystem::PrewarmWeapon(UWorld& InWorld, const EWeaponType WeaponType)
+{
+	const FWeaponDataTable* Definition = UWeaponDefinitionSubsystem::FindDefinition(WeaponType);
+
+	// Load up front rather than waiting for the streamer, but only hold on for the warm-up below. Whether the assets
+	// stay resident afterwards is the weapon asset subsystem's call, same as for any other weapon
+	TArray<FSoftObjectPath> Assets;
+	Definition->GetStreamedAssets(Assets);
+	TSharedPtr<FStreamableHandle> Handle;
+	if (Assets.Num() > 0)
+	{
+		const double StartTime = FPlatformTime::Seconds();
+		Handle = StreamableManager.RequestSyncLoad(Assets);
+		UE_LOG(LogWeaponPrewarm, Log, TEXT("Load %d assets for %s: %.2f ms"), Assets.Num(),
+			   *UEnum::GetValueAsString(WeaponType), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+	}
+
+	UNiagaraSystem* HitParticleSystem = Definition->HitParticleSystem.Get();
+	TimePrewarm(TEXT("Simulate"), HitParticleSystem, [&] { PrewarmNiagaraSystem(InWorld, HitParticleSystem); });
+	if (UImpactEffectSubsystem* ImpactEffects = InWorld.GetSubsystem<UImpactEffectSubsystem>())
+	{
+		TimePrewarm(TEXT("Pool"), HitParticleSystem, [&] { ImpactEffects->Prewarm(HitParticleSystem, ImpactPoolPrewarmCount); });
+	}
+
+	UNiagaraSystem* TracerParticleSystem = Definition->TracerParticleSystem.Get();
+	TimePrewarm(TEXT("Simulate"), TracerParticleSystem, [&] { PrewarmNiagaraSystem(InWorld, TracerParticleSystem); });
+
+	UParticleSystem* MuzzleFlash = Definition->MuzzleFlash.Get();
+	TimePrewarm(TEXT("Simulate"), MuzzleFlash, [&] { PrewarmParticleSystem(InWorld, MuzzleFlash); });
+
+	for (const TSoftObjectPtr<USoundBase>& Sound : {Definition->FireSound, Definition->FireLoopSound, Definition->FireTailSound})
+	{
+		USoundBase* LoadedSound = Sound.Get();
+		TimePrewarm(TEXT("Prime"), LoadedSound, [&] { PrewarmSound(LoadedSound); });
+	}
+
+	if (Definition->DamageMode == EDamageMode::EDM_PROJECTILE && !UProjectileManagerSubsystem::CanSimulate(Definition->Projectile))
+	{
+		if (UProjectilePoolSubsystem* ProjectilePool = InWorld.GetSubsystem<UProjectilePoolSubsystem>())
+		{
+			TimePrewarm(TEXT("Pool"), Definition->Projectile.Get(), [&] { ProjectilePool->Prewarm(Definition->Projectile); });
+		}
+	}
+
+	if (Handle.IsValid())
+	{
+		Handle->ReleaseHandle();
+	}
+}
+
+void UWeaponPrewarmSubsystem::PrewarmNiagaraSystem(UWorld& InWorld, UNiagaraSystem* System) const
+{
+	UNiagaraComponent* Component = UNiagaraFunctionLibrary::SpawnSystemAtLocation(&InWorld, System, PrewarmLocation,
+		FRotator::ZeroRotator, FVector::OneVector, false, true, ENCPoolMethod::None, false);
+	if (Component == nullptr) return;
+
+	Component->AdvanceSimulation(EffectPrewarmTicks, EffectPrewarmTickDelta);
+	Component->DeactivateImmediate();
+	Component->DestroyComponent();
+}
+
+void UWeaponPrewarmSubsystem::PrewarmParticleSystem(UWorld& InWorld, UParticleSystem* System) const
+{
+	UParticleSystemComponent* Component = UGameplayStatics::SpawnEmitterAtLocation(&InWorld, System, PrewarmLocation,
+		FRotator::ZeroRotator, false);
+	if (Component == nullptr) return;
+
+	for (int32 Tick = 0; Tick < EffectPrewarmTicks; ++Tick)
+	{
+		Component->TickComponent(EffectPrewarmTickDelta, LEVELTICK_All, nullptr);
+	}
+	Component->DeactivateImmediate();
+	Component->DestroyComponent();
+}
+
+void UWeaponPrewarmSubsystem::PrewarmSound(USoundBase* Sound) const
+{
+	// Sounds that decompress on load already did so above; this pulls in the first chunk of streamed ones
+	UGameplayStatics::PrimeSound(Sound);
+}
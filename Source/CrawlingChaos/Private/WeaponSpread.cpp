@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WeaponSpread.h"
+
+#include "SpreadPattern.h"
+
+void FWeaponSpread::GeneratePelletDirections(const FFireView& View, const float HorizontalSpread,
+											 const float VerticalSpread, const USpreadPattern* Pattern,
+											 const uint32 Seed, const uint32 ShotIndex,
+											 TArrayView<FVector> OutDirections)
+{
+	const int32 NumPellets = OutDirections.Num();
+	TArray<FVector2D, TInlineAllocator<32>> Offsets;
+	Offsets.SetNumUninitialized(NumPellets);
+	if (Pattern != nullptr)
+	{
+		Pattern->GetPelletOffsets(Seed, ShotIndex, Offsets);
+	}
+	else
+	{
+		// Uniform over the unit disc
+		const FRandomStream Stream{static_cast<int32>(USpreadPattern::HashShot(Seed, ShotIndex))};
+		for (FVector2D& Offset : Offsets)
+		{
+			const float Radius = FMath::Sqrt(Stream.GetFraction());
+			float Sin;
+			float Cos;
+			FMath::SinCos(&Sin, &Cos, Stream.GetFraction() * 2.f * PI);
+			Offset = FVector2D{Radius * Cos, Radius * Sin};
+		}
+	}
+
+	// Straight-line math over the pellets: stretch the unit-disc offsets to the cone's extents
+	const FVector RightExtent{View.Right * PixelsToTangent(HorizontalSpread, View.TanHalfFOV)};
+	const FVector UpExtent{View.Up * PixelsToTangent(VerticalSpread, View.TanHalfFOV)};
+	for (int32 PelletIndex = 0; PelletIndex < NumPellets; ++PelletIndex)
+	{
+		const FVector2D& Offset = Offsets[PelletIndex];
+		OutDirections[PelletIndex] = (View.Forward + RightExtent * Offset.X + UpExtent * Offset.Y).GetUnsafeNormal();
+	}
+}
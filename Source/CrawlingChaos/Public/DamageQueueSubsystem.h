@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "DamageQueueSubsystem.generated.h"
+
+class AController;
+class UDamageType;
+
+/** All the damage one actor has taken this frame, reduced into a single hit */
+struct FQueuedDamage
+{
+	TWeakObjectPtr<AActor> Victim;
+
+	/** Sum of every hit */
+	float Amount{0.f};
+
+	/** The hardest single hit; its hit info, instigator and type describe the whole event */
+	float StrongestAmount{0.f};
+	FHitResult Hit;
+	FVector ShotDirection{FVector::ZeroVector};
+	TWeakObjectPtr<AController> Instigator;
+	TWeakObjectPtr<AActor> DamageCauser;
+	TSubclassOf<UDamageType> DamageTypeClass;
+
+	/** Number of hits folded into this one */
+	int32 NumHits{0};
+};
+
+/**
+ * Collects damage during the frame and hands each victim a single point damage event for all of it, after every
+ * actor has ticked. Keeps Blueprint damage events, health bar updates and death logic to once per victim per frame
+ * no matter how many pellets or explosions landed.
+ */
+UCLASS()
+class CRAWLINGCHAOS_API UDamageQueueSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Queue damage for the victim; it's folded in with everything else the victim takes this frame */
+	void QueueDamage(AActor* Victim, float Amount, const FHitResult& Hit, const FVector& ShotDirection,
+					 AController* Instigator, AActor* DamageCauser, TSubclassOf<UDamageType> DamageTypeClass);
+
+	/** Number of victims waiting for the end of the frame */
+	int32 GetNumPendingVictims() const { return PendingDamage.Num(); }
+
+	/** Broadcast right before the frame's damage goes out, so sources that resolve late in the frame, like explosions,
+	 *  can still get theirs in whichever order the tickables run */
+	FSimpleMulticastDelegate OnBeforeDispatch;
+
+private:
+	/** Damage waiting for the end of the frame, one entry per victim */
+	TArray<FQueuedDamage> PendingDamage;
+
+	/** Index into PendingDamage for every victim */
+	TMap<TWeakObjectPtr<AActor>, int32> VictimIndices;
+};
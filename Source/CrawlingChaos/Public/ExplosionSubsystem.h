@@ -0,0 +1,132 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+
+#include "ExplosionSubsystem.generated.h"
+
+class ACrawlingChaosProjectile;
+class AController;
+class UDamageType;
+class UPrimitiveComponent;
+
+/** How hard an explosion hits and how quickly that drops off with distance */
+USTRUCT(BlueprintType)
+struct FExplosionSettings
+{
+	GENERATED_BODY()
+
+	/** Damage inside the inner radius */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float BaseDamage = 100.f;
+
+	/** Damage at the outer radius */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MinimumDamage = 10.f;
+
+	/** Everything closer than this takes the full damage */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float InnerRadius = 100.f;
+
+	/** Nothing further than this is affected */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float OuterRadius = 500.f;
+
+	/** Exponent of the falloff between the inner and outer radius; 1 is linear */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float DamageFalloff = 1.f;
+
+	/** Change in speed given to simulating bodies inside the inner radius, in cm/s */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float ImpulsePerUnitMass = 1500.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSubclassOf<UDamageType> DamageTypeClass;
+
+	/** Scale of the damage and impulse at a distance from the origin, 0 to 1 */
+	float GetFalloff(float Distance) const;
+};
+
+/** A detonation waiting for the end of the frame */
+struct FQueuedExplosion
+{
+	FVector Origin{FVector::ZeroVector};
+	FExplosionSettings Settings;
+	TWeakObjectPtr<AActor> DamageCauser;
+	TWeakObjectPtr<AController> InstigatorController;
+};
+
+/** A component inside an explosion's radius, waiting on its line-of-sight trace */
+struct FExplosionTarget
+{
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+
+	/** Explosion in the batch this target belongs to */
+	int32 ExplosionIndex{INDEX_NONE};
+
+	/** Falloff at the target's distance */
+	float Falloff{0.f};
+
+	/** Where the line-of-sight trace aims */
+	FVector Location{FVector::ZeroVector};
+
+	FTraceHandle Trace;
+};
+
+/**
+ * Resolves radial damage and impulses natively. Detonations queued during a frame are clustered so overlapping
+ * ones share a single overlap query, falloff for every body found is computed in one pass, and line of sight is
+ * checked with async traces. Once the traces are back, next frame, damage goes through the damage queue and impulses
+ * through the impulse accumulator.
+ */
+UCLASS()
+class CRAWLINGCHAOS_API UExplosionSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Queue a detonation to be resolved at the end of the frame */
+	UFUNCTION(BlueprintCallable, Category = "Explosion")
+	void QueueExplosion(const FVector& Origin, const FExplosionSettings& Settings, AActor* DamageCauser,
+						AController* InstigatorController);
+
+private:
+	/** Explode simulated projectiles that are set to explode on impact */
+	void OnSimulatedProjectileImpact(TSubclassOf<ACrawlingChaosProjectile> ProjectileClass, AActor* ProjectileOwner,
+									 const FHitResult& Hit);
+
+	/** Group the queued detonations, find what they reach and send out the line-of-sight traces */
+	void GatherTargets();
+
+	/** Apply damage and impulses for every target whose line of sight came back clear */
+	void ResolveTargets();
+
+	/** Resolve last frame's detonations if that hasn't happened yet this frame. Run from our own tick and right
+	 *  before the damage queue dispatches, whichever comes first, so blasts land in the same event as that frame's
+	 *  pellets */
+	void ResolveTargetsIfReady();
+
+	/** Detonations queued this frame */
+	TArray<FQueuedExplosion> QueuedExplosions;
+
+	/** Detonations whose targets are waiting on traces */
+	TArray<FQueuedExplosion> PendingExplosions;
+	TArray<FExplosionTarget> PendingTargets;
+
+	/** Frame the pending traces went out on; they can't be back before the next one */
+	uint64 PendingTraceFrame = 0;
+
+	FDelegateHandle ProjectileImpactHandle;
+	FDelegateHandle DamageDispatchHandle;
+};
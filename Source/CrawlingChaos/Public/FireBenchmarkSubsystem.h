@@ -0,0 +1,112 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Enums/WeaponType.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "FireBenchmarkSubsystem.generated.h"
+
+class ACrawlingChaosCharacter;
+class AWeapon;
+
+/** Everything measured while one weapon type was being fired */
+struct FFireBenchmarkPhase
+{
+	EWeaponType WeaponType{EWeaponType::EWT_DefaultMAX};
+
+	/** Game thread time of every frame in the phase, in milliseconds */
+	TArray<float> GameThreadMs;
+
+	/** Rounds fired by every shooter, and the pellets they were split into */
+	int64 RoundsFired{0};
+	int64 PelletsFired{0};
+
+	/** Every trace and sweep issued during the phase: two per hitscan pellet, plus projectile sweeps and blast traces */
+	int64 TracesIssued{0};
+
+	int32 PeakActorCount{0};
+	int32 PeakLiveMIDs{0};
+	uint64 PeakUsedPhysical{0};
+};
+
+/**
+ * Measures the cost of the fire path. Spawns a number of pickups and scripted shooters in the current map, then
+ * has every shooter fire each weapon type in its configured fire mode for a fixed number of frames. Each frame's
+ * game thread time, rounds, traces, actor count and memory go to the CSV profiler under the CrawlingChaos category,
+ * and a JSON report to diff between builds, with each phase's peak live MIDs as well, is written to the profiling
+ * directory.
+ *
+ * Run with CrawlingChaos.FireBenchmark [Shooters] [Pickups] [FramesPerWeapon] in any map, or headless on every map
+ * in BenchmarkMaps through the automation test:
+ * -game -nullrhi -ExecCmds="Automation RunTests CrawlingChaos.Performance.FireBenchmark; Quit"
+ */
+UCLASS(config=Game)
+class CRAWLINGCHAOS_API UFireBenchmarkSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Spawn everything and start firing. Does nothing if a benchmark is already running */
+	void StartBenchmark(int32 NumShooters, int32 NumPickups, int32 FramesPerWeapon);
+
+	bool IsRunning() const { return bRunning; }
+
+	/** Did the last finished benchmark manage to write its report? */
+	bool WasReportWritten() const { return bReportWritten; }
+
+	/** Where the last finished benchmark's report went */
+	const FString& GetReportPath() const { return ReportPath; }
+
+	/** Maps the automation test runs the benchmark on */
+	UPROPERTY(Config)
+	TArray<FString> BenchmarkMaps;
+
+	/** What a run is set up with unless told otherwise */
+	static constexpr int32 DefaultNumShooters{8};
+	static constexpr int32 DefaultNumPickups{32};
+	static constexpr int32 DefaultFramesPerWeapon{300};
+
+private:
+	/** Move every shooter onto the next weapon type, or finish if they've fired them all */
+	void BeginPhase(EWeaponType WeaponType);
+
+	/** Record this frame and keep every trigger held */
+	void SampleFrame();
+
+	/** Clean up, write the report, and exit if asked to */
+	void FinishBenchmark();
+
+	/** Returns false if the report couldn't be saved */
+	bool WriteReport();
+
+	/** Total shots fired by every shooter's weapon of the current type */
+	int64 CountRoundsFired() const;
+
+	UPROPERTY()
+	TArray<ACrawlingChaosCharacter*> Shooters;
+
+	UPROPERTY()
+	TArray<AWeapon*> Pickups;
+
+	TArray<FFireBenchmarkPhase> Phases;
+
+	/** Shots the shooters had fired, and traces issued, before the current frame */
+	int64 LastRoundsFired{0};
+	uint64 LastTracesIssued{0};
+
+	int32 FramesPerPhase{0};
+	int32 NumPickupsSpawned{0};
+	bool bRunning{false};
+
+	FString ReportPath;
+	bool bReportWritten{false};
+};
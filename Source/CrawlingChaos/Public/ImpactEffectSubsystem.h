@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "ImpactEffectSubsystem.generated.h"
+
+class UNiagaraComponent;
+class UNiagaraSystem;
+
+/** Components for a single impact system */
+USTRUCT()
+struct FImpactEffectPool
+{
+	GENERATED_BODY()
+
+	/** Idle components ready to be reused */
+	UPROPERTY()
+	TArray<UNiagaraComponent*> Free;
+
+	/** Components currently playing, handed back to Free when they finish */
+	UPROPERTY()
+	TArray<UNiagaraComponent*> Active;
+};
+
+/** Impacts that landed close together this frame, played as one burst */
+struct FImpactBurst
+{
+	UNiagaraSystem* System = nullptr;
+	FVector Location{FVector::ZeroVector};
+	FVector Normal{FVector::UpVector};
+	int32 Count = 0;
+};
+
+/**
+ * Plays hit effects through pooled Niagara components. Impacts queued during a frame are merged when they land
+ * close together and spawned at the end of the frame, no more than SpawnBudgetPerFrame at a time.
+ */
+UCLASS(config=Game)
+class CRAWLINGCHAOS_API UImpactEffectSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UImpactEffectSubsystem();
+	
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Queue an impact effect to be played at the end of the frame */
+	void QueueImpact(UNiagaraSystem* System, const FVector& Location, const FVector& Normal);
+
+	/** Create idle components for the system up front so its first impact doesn't allocate */
+	void Prewarm(UNiagaraSystem* System, int32 Count);
+
+	/** Number of impacts dropped because the frame's spawn budget ran out */
+	int32 GetNumDroppedImpacts() const { return NumDroppedImpacts; }
+
+private:
+	/** Take an idle component for the system, or create one if the system has room */
+	UNiagaraComponent* AcquireComponent(UNiagaraSystem* System);
+
+	/** Create a new idle component for the system */
+	UNiagaraComponent* CreateComponent(UNiagaraSystem* System);
+
+	/** Return a finished component to its pool */
+	UFUNCTION()
+	void OnImpactEffectFinished(UNiagaraComponent* FinishedComponent);
+
+	/** Impacts closer together than this in the same frame are merged into one burst */
+	UPROPERTY(Config)
+	float MergeDistance;
+
+	/** Most bursts spawned in a single frame */
+	UPROPERTY(Config)
+	int32 SpawnBudgetPerFrame;
+
+	/** Most components kept per system, idle and playing combined */
+	UPROPERTY(Config)
+	int32 MaxComponentsPerSystem;
+
+	UPROPERTY()
+	TMap<UNiagaraSystem*, FImpactEffectPool> Pools;
+
+	/** Bursts waiting for the end of the frame */
+	TArray<FImpactBurst> PendingBursts;
+
+	int32 NumDroppedImpacts;
+};
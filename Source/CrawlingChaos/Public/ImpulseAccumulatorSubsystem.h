@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "ImpulseAccumulatorSubsystem.generated.h"
+
+class UPrimitiveComponent;
+
+/** Every impulse one body has received this frame, merged into one */
+struct FPendingImpulse
+{
+	TWeakObjectPtr<UPrimitiveComponent> Component;
+
+	/** Body of the component the impulse goes to; NAME_None for single-body components */
+	FName BoneName;
+
+	/** Sum of the impulses */
+	FVector Impulse{FVector::ZeroVector};
+
+	/** Impulse-weighted average of where they landed */
+	FVector Location{FVector::ZeroVector};
+
+	/** Sum of the impulse sizes, used to weight the location */
+	float Weight{0.f};
+};
+
+/**
+ * Collects physics impulses during the frame, merges them per component and body, and hands them all to the
+ * physics scene in a single write at the end of the frame
+ */
+UCLASS()
+class CRAWLINGCHAOS_API UImpulseAccumulatorSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/**
+	 * Queue an impulse for the body of the component. Ignored unless the body is simulating physics.
+	 * @return true if the impulse was queued
+	 */
+	bool AddImpulseAtLocation(UPrimitiveComponent* Component, FName BoneName, const FVector& Impulse, const FVector& Location);
+
+	/** Number of bodies with impulses waiting for the end of the frame */
+	int32 GetNumPendingImpulses() const { return PendingImpulses.Num(); }
+
+private:
+	/** Impulses waiting for the end of the frame, one per body */
+	TArray<FPendingImpulse> PendingImpulses;
+};
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "Enums/AmmoType.h"
+#include "Enums/WeaponType.h"
+
+#include "InventoryComponent.generated.h"
+
+class UWeaponInstance;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnAmmoChanged, EAmmoType, AmmoType, int32, NewAmount);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnWeaponAdded, UWeaponInstance*, Weapon);
+
+/**
+ * Ammo and weapons carried by a character, stored in fixed arrays indexed directly by EAmmoType and EWeaponType
+ * so the fire, swap and pickup paths never have to hash. Weapons are carried as lightweight instances; only the
+ * one in hand has an actor.
+ */
+UCLASS(ClassGroup=(Custom), meta=(BlueprintSpawnableComponent))
+class CRAWLINGCHAOS_API UInventoryComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UInventoryComponent();
+
+	/** Get the amount of ammo of the given type */
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	int32 GetAmmo(EAmmoType AmmoType) const
+	{
+		return Ammo[AmmoIndex(AmmoType)];
+	}
+
+	/** Set the amount of ammo of the given type */
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	void SetAmmo(EAmmoType AmmoType, int32 Amount);
+
+	/** Add ammo of the given type */
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	void AddAmmo(EAmmoType AmmoType, int32 Amount);
+
+	/** Take up to Amount rounds of the given type in one go. Returns how many were actually taken */
+	UFUNCTION(BlueprintCallable, Category = Inventory)
+	int32 ConsumeAmmo(EAmmoType AmmoType, int32 Amount);
+
+	/** Get the carried weapon of the given type, or null if we don't have one */
+	UWeaponInstance* GetWeapon(EWeaponType WeaponType) const
+	{
+		return Weapons[WeaponIndex(WeaponType)];
+	}
+
+	/** Returns true if a weapon of the given type is carried */
+	bool HasWeapon(EWeaponType WeaponType) const
+	{
+		return GetWeapon(WeaponType) != nullptr;
+	}
+
+	/** Create a weapon of the given type in its slot. Returns null if a weapon of that type is already carried */
+	UWeaponInstance* AddWeapon(EWeaponType WeaponType);
+
+	// Called when the owner is destroyed or its level unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Broadcast whenever the amount of any ammo type changes */
+	UPROPERTY(BlueprintAssignable, Category = Inventory)
+	FOnAmmoChanged OnAmmoChanged;
+
+	/** Broadcast whenever a weapon is added */
+	UPROPERTY(BlueprintAssignable, Category = Inventory)
+	FOnWeaponAdded OnWeaponAdded;
+
+private:
+	static int32 AmmoIndex(const EAmmoType AmmoType)
+	{
+		checkSlow(AmmoType < EAmmoType::EAT_MAX);
+		return static_cast<int32>(AmmoType);
+	}
+
+	static int32 WeaponIndex(const EWeaponType WeaponType)
+	{
+		checkSlow(WeaponType < EWeaponType::EWT_DefaultMAX);
+		return static_cast<int32>(WeaponType);
+	}
+
+	/** Ammo carried, indexed by EAmmoType */
+	UPROPERTY(EditAnywhere, EditFixedSize, Category = Inventory)
+	TArray<int32> Ammo;
+
+	/** Weapons carried, indexed by EWeaponType */
+	UPROPERTY(VisibleAnywhere, EditFixedSize, Category = Inventory)
+	TArray<UWeaponInstance*> Weapons;
+};
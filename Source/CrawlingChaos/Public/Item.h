@@ -6,6 +6,43 @@
 #include "GameFramework/Actor.h"
 #include "Item.generated.h"
 
+class ACrawlingChaosCharacter;
+class UMaterialInstanceDynamic;
+class UStaticMesh;
+
+/** Custom primitive data slots item materials read their per-item variation from */
+namespace ItemMaterialData
+{
+	/** Emissive strength */
+	constexpr int32 Glow{0};
+
+	/** Rarity tint, as red, green and blue in consecutive slots */
+	constexpr int32 Tint{1};
+
+	/** 1 while the item lies in the world waiting to be collected; drives its pulse */
+	constexpr int32 PickupPulse{4};
+
+	constexpr int32 Num{5};
+}
+
+/** How an item's components should be set up in one of its states */
+struct FItemComponentState
+{
+	/** Item mesh */
+	bool bMeshVisible;
+	bool bMeshCastShadow;
+	ECollisionEnabled::Type MeshCollisionEnabled;
+	ECollisionResponse MeshCollisionResponse;
+	bool bMeshSimulatePhysics;
+	bool bMeshEnableGravity;
+
+	/** Can characters collect the item? Drawn through the pickup render subsystem if it has a static stand-in */
+	bool bPickup;
+
+	/** Should the item bob in place? */
+	bool bOscillate;
+};
+
 UCLASS()
 class CRAWLINGCHAOS_API AItem : public AActor
 {
@@ -19,33 +56,101 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-	/** Oscillate the item in place while it's on the map and not picked up*/
-	void OscillateInPlace();
+	// Called when the actor is spawned, moved, or a property is changed
+	virtual void OnConstruction(const FTransform& Transform) override;
 
-	/** Callback that resets the oscillate timer */
-	void OscillateCallback();
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	// Called when the item is destroyed or its level unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Hand the item to the oscillation subsystem, or take it back */
+	void UpdateOscillationRegistration();
+
+	/** Put the item in the pickup subsystem's hash while it can be collected, or take it out */
+	void UpdatePickupRegistration();
+
+	/** Draw the pickup through the pickup render subsystem once its static mesh has streamed in, or stop */
+	void UpdatePickupInstance();
+
+	/** Move the components to the target state, touching only the properties that differ from the last one applied */
+	void ApplyComponentState(const FItemComponentState& TargetState);
+
+	/** Create the skeletal mesh the first time something needs to see it */
+	USkeletalMeshComponent* CreateItemMesh();
 
-	void SetCanOscillate(bool bShouldOscillate) { bCanOscillate = bShouldOscillate; };
+	/** The skeletal mesh was just created; dress it */
+	virtual void OnItemMeshCreated() {}
+public:	
+	/** Start or stop the item bobbing in place */
+	void SetCanOscillate(bool bShouldOscillate);
 	bool GetCanOscillate() const { return bCanOscillate; };
 
+	/** Curve the item bobs along */
+	UCurveFloat* GetOscCurve() const { return OscCurve; }
+
+	/** Length of one bob, in seconds */
+	float GetOscCurveLength() const { return OscCurveLength; }
+
 	void Equip();
+
+	/** Is the item being drawn as an instance rather than through its own mesh? */
+	bool IsPickupInstanced() const { return bPickupInstanced; }
+
+	/** Set per-item material variation, read from custom primitive data so every item keeps sharing its material */
+	void SetMaterialData(int32 DataIndex, float Value);
+	void SetMaterialData(int32 DataIndex, const FLinearColor& Color);
+
+	/**
+	 * Swap the item mesh's material for a dynamic instance of it, for effects custom primitive data can't express.
+	 * Each one breaks batching with every other item, so only ask when there's no other way. Null while the item is
+	 * drawn without its own mesh, as instanced pickups are
+	 */
+	UFUNCTION(BlueprintCallable, Category = Item)
+	UMaterialInstanceDynamic* GetOrCreateDynamicMaterial(int32 ElementIndex = 0);
+
+	/** Called by the pickup subsystem when a character comes within the area sphere */
+	virtual void OnCollected(ACrawlingChaosCharacter* Collector) {}
 protected:
-	/** Item mesh */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AllowPrivateAccess = true))
+	/** Root the item's components hang off */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Gameplay, meta = (AllowPrivateAccess = true))
+	USceneComponent* ItemRoot;
+
+	/** Item mesh. Only created once the item is equipped, or otherwise has to be seen without a pickup instance */
+	UPROPERTY(VisibleInstanceOnly, Transient, BlueprintReadOnly, Category = Gameplay, meta = (AllowPrivateAccess = true))
 	USkeletalMeshComponent* ItemMesh;
 
-	/** Area sphere for overlapping item pickup */
+	/** Static version of the item mesh, drawn instanced while the item lies in the world as a pickup */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Item, meta = (AllowPrivateAccess = true))
+	TSoftObjectPtr<UStaticMesh> PickupStaticMesh;
+
+	/** Values for each ItemMaterialData slot, handed to the item mesh or pickup instance */
+	TArray<float> MaterialData;
+
+	/** Radius a character has to come within to collect the item. Never collides; the pickup subsystem checks it */
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = Item, meta = (AllowPrivateAccess = true))
 	class USphereComponent* AreaSphere;
 
 	/** Item oscillation while on the map */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Item, meta = (AllowPrivateAccess = true))
 	UCurveFloat* OscCurve;
-	FTimerHandle OscTimer;
 	float OscCurveLength;
 	FVector InitialLocation;
 	bool bCanOscillate;
+
+	/** Is the oscillation subsystem currently bobbing this item? */
+	bool bOscillationRegistered;
+
+	/** Can the item be collected, and is it in the pickup subsystem's hash? */
+	bool bCanBePickedUp;
+	bool bPickupRegistered;
+
+	/** Should the item be drawn as a pickup instance, and is it? */
+	bool bWantsPickupInstance;
+	bool bPickupInstanced;
+
+	/** Is the item mesh meant to be visible, given the last state and whether an instance stands in for it */
+	bool bItemMeshShown;
+
+	/** Component state last applied, valid once bComponentStateApplied is set */
+	FItemComponentState AppliedComponentState;
+	bool bComponentStateApplied;
 };
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "ItemOscillationSubsystem.generated.h"
+
+class AItem;
+class UCurveFloat;
+
+/** An item bobbing in place around its base location */
+USTRUCT()
+struct FOscillatingItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	AItem* Item = nullptr;
+
+	/** Location the item bobs around */
+	FVector BaseLocation{FVector::ZeroVector};
+};
+
+/** Items that share a curve and started bobbing at the same time, so the curve only needs evaluating once */
+USTRUCT()
+struct FOscillationGroup
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UCurveFloat* Curve = nullptr;
+
+	/** Length of one bob, in seconds */
+	float Period = 0.f;
+
+	/** World time the group started bobbing */
+	double StartTime = 0.0;
+
+	UPROPERTY()
+	TArray<FOscillatingItem> Items;
+};
+
+/**
+ * Bobs every pickup in the world from one tick, so items themselves don't have to tick at all.
+ * Each group's curve is evaluated once per frame and the offset applied to all of its items in one pass.
+ */
+UCLASS()
+class CRAWLINGCHAOS_API UItemOscillationSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Start bobbing the item around the given location */
+	void Register(AItem* Item, const FVector& BaseLocation);
+
+	/** Stop bobbing the item, leaving it wherever it currently is */
+	void Unregister(AItem* Item);
+
+	/** Number of items currently bobbing */
+	int32 GetNumItems() const;
+
+private:
+	UPROPERTY()
+	TArray<FOscillationGroup> Groups;
+};
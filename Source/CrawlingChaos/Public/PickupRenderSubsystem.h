@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "PickupRenderSubsystem.generated.h"
+
+class AItem;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/** Every pickup drawn with one static mesh */
+USTRUCT()
+struct FPickupMeshInstances
+{
+	GENERATED_BODY()
+
+	/** All pickups using the mesh are drawn through this one component */
+	UPROPERTY()
+	UInstancedStaticMeshComponent* Instances = nullptr;
+
+	/** World transform of every instance, by instance index, so they can be handed over in a single batch */
+	TArray<FTransform> Transforms;
+
+	/** Instances left behind by removed pickups, collapsed to nothing and reused before the component grows */
+	TArray<int32> FreeInstances;
+
+	/** Have instances moved since their transforms were last handed to the component? */
+	bool bInstancesMoved = false;
+
+	/** Have instances come, gone or changed their custom data since the render state was last pushed? */
+	bool bRenderStateDirty = false;
+};
+
+/** Where a pickup's instance lives */
+struct FPickupInstance
+{
+	int32 MeshIndex{INDEX_NONE};
+	int32 InstanceIndex{INDEX_NONE};
+};
+
+/**
+ * Draws world pickups as instances of a static stand-in for their mesh, one instanced component per mesh, so a
+ * level full of pickups costs a handful of draw calls rather than one skeletal mesh each. Pickups bob every frame,
+ * so the components are plain instanced ones with no cluster tree to go stale; moved instances reach each component
+ * in one batched transform update a frame.
+ */
+UCLASS()
+class CRAWLINGCHAOS_API UPickupRenderSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Start drawing the pickup as an instance of the mesh, with its material data. Returns false if it couldn't be */
+	bool AddPickup(const AItem* Item, UStaticMesh* Mesh, const FTransform& Transform, const TArray<float>& MaterialData);
+
+	/** Stop drawing the pickup */
+	void RemovePickup(const AItem* Item);
+
+	/** Move the pickup's instance. Pushed to the renderer with everything else moved this frame */
+	void SetPickupLocation(const AItem* Item, const FVector& Location);
+
+	/** Hand the pickup's instance new custom data for its material */
+	void SetPickupMaterialData(const AItem* Item, const TArray<float>& MaterialData);
+
+	/** Number of pickups being drawn */
+	int32 GetNumPickups() const { return Pickups.Num(); }
+
+	/** Number of instanced components, and so draw batches, the pickups are spread across */
+	int32 GetNumMeshes() const { return Meshes.Num(); }
+
+private:
+	/** Index of the component drawing the mesh, creating it if this is the first pickup to use it */
+	int32 FindOrAddMesh(UStaticMesh* Mesh, int32 NumMaterialData);
+
+	/** Owns the instanced components */
+	UPROPERTY()
+	AActor* RenderActor = nullptr;
+
+	UPROPERTY()
+	TArray<FPickupMeshInstances> Meshes;
+
+	TMap<const AItem*, FPickupInstance> Pickups;
+};
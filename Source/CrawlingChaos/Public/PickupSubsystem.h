@@ -0,0 +1,80 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "PickupSubsystem.generated.h"
+
+class AItem;
+class ACrawlingChaosCharacter;
+
+/** A stationary pickup in the spatial hash */
+struct FPickupEntry
+{
+	TWeakObjectPtr<AItem> Item;
+	FVector Location{FVector::ZeroVector};
+
+	/** How close a character has to get to collect it */
+	float Radius{0.f};
+
+	FIntPoint Cell{FIntPoint::ZeroValue};
+};
+
+/**
+ * Indexes stationary pickups in a uniform grid on the ground plane, so nothing has to rely on physics overlaps to
+ * find them. Characters that can collect pickups check their neighbourhood of cells every QueryInterval seconds,
+ * and only the pickups found there are tested and handed over.
+ */
+UCLASS(config=Game)
+class CRAWLINGCHAOS_API UPickupSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UPickupSubsystem();
+
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Add a pickup at its current location, or move it if it's already in */
+	void RegisterPickup(AItem* Item, float Radius);
+	void UnregisterPickup(AItem* Item);
+
+	/** Let a character collect pickups it comes close to */
+	void RegisterCollector(ACrawlingChaosCharacter* Collector);
+	void UnregisterCollector(ACrawlingChaosCharacter* Collector);
+
+	/** Find every pickup whose collection radius reaches within Radius of Location */
+	void QueryPickups(const FVector& Location, float Radius, TArray<AItem*>& OutItems) const;
+
+	int32 GetNumPickups() const { return Entries.Num(); }
+
+private:
+	FIntPoint GetCell(const FVector& Location) const;
+
+	/** Pickups, and the cells that hold their indices */
+	TSparseArray<FPickupEntry> Entries;
+	TMap<FIntPoint, TArray<int32, TInlineAllocator<4>>> Cells;
+	TMap<const AItem*, int32> EntryIndices;
+
+	/** Largest collection radius registered, so queries know how far out to look */
+	float MaxPickupRadius;
+
+	TArray<TWeakObjectPtr<ACrawlingChaosCharacter>> Collectors;
+
+	/** Width of a grid cell */
+	UPROPERTY(Config)
+	float CellSize;
+
+	/** Seconds between collectors checking for pickups */
+	UPROPERTY(Config)
+	float QueryInterval;
+
+	float TimeSinceQuery;
+};
@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Blueprint/UserWidget.h"
+#include "Enums/AmmoType.h"
+
+#include "PlayerHUDWidget.generated.h"
+
+class ACrawlingChaosCharacter;
+class APawn;
+class UImage;
+class UInvalidationBox;
+class UProgressBar;
+class UTextBlock;
+class UTexture2D;
+class UWeaponInstance;
+
+/**
+ * The player's HUD: crosshair, ammo, equipped weapon and health. Everything sits inside an invalidation box and is
+ * only touched when the character reports a change, so frames where nothing changed cost next to no Slate time.
+ * Blueprint subclasses can lay the widgets out themselves by naming them to match. Any piece left out is built here
+ * and placed on the canvas inside HUDCache, or on the root if it's a canvas and there's no HUDCache; a layout with
+ * neither has to provide every piece itself.
+ */
+UCLASS()
+class CRAWLINGCHAOS_API UPlayerHUDWidget : public UUserWidget
+{
+	GENERATED_BODY()
+
+public:
+	/** Follow the given character's events, or stop following anything if null */
+	void SetCharacter(ACrawlingChaosCharacter* NewCharacter);
+
+	void SetCrosshairTexture(UTexture2D* Texture);
+
+protected:
+	virtual void NativeOnInitialized() override;
+	virtual void NativeDestruct() override;
+
+private:
+	/** Build each piece of the layout a subclass didn't provide */
+	void BuildDefaultLayout();
+
+	/** Follow the owning player's pawn as it changes */
+	UFUNCTION()
+	void OnPossessedPawnChanged(APawn* OldPawn, APawn* NewPawn);
+
+	UFUNCTION()
+	void OnAmmoChanged(EAmmoType AmmoType, int32 NewAmount);
+
+	UFUNCTION()
+	void OnEquippedWeaponChanged(UWeaponInstance* Weapon);
+
+	UFUNCTION()
+	void OnHealthChanged(float Health, float MaxHealth);
+
+	/** Show the ammo left for the weapon in hand */
+	void RefreshAmmo();
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UInvalidationBox* HUDCache;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UImage* Crosshair;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock* AmmoText;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UTextBlock* WeaponText;
+
+	UPROPERTY(meta = (BindWidgetOptional))
+	UProgressBar* HealthBar;
+
+	/** Character whose events we're following */
+	TWeakObjectPtr<ACrawlingChaosCharacter> Character;
+
+	/** Ammo type of the weapon in hand, so changes to other ammo types are ignored */
+	EAmmoType DisplayedAmmoType{EAmmoType::EAT_Pistol};
+	bool bHasAmmoType{false};
+};
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "WorldCollision.h"
+
+#include "ProjectileManagerSubsystem.generated.h"
+
+class ACrawlingChaosProjectile;
+class UInstancedStaticMeshComponent;
+
+/** Called on the game thread when a simulated projectile hits something */
+DECLARE_MULTICAST_DELEGATE_ThreeParams(FOnSimulatedProjectileImpact, TSubclassOf<ACrawlingChaosProjectile> /*ProjectileClass*/,
+									   AActor* /*Owner*/, const FHitResult& /*Hit*/);
+
+/** Everything the manager needs to simulate and render one projectile class, read from its defaults */
+USTRUCT()
+struct FSimulatedProjectileType
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TSubclassOf<ACrawlingChaosProjectile> ProjectileClass;
+
+	/** All projectiles of this type are drawn through this one component */
+	UPROPERTY()
+	UInstancedStaticMeshComponent* Instances = nullptr;
+
+	float InitialSpeed = 0.f;
+	float MaxSpeed = 0.f;
+	float GravityZ = 0.f;
+	float LifeSpan = 0.f;
+	float Radius = 0.f;
+	ECollisionChannel CollisionChannel = ECC_WorldDynamic;
+	FCollisionResponseParams ResponseParams;
+
+	/** Scratch space for this frame's instance transforms */
+	TArray<FTransform> InstanceTransforms;
+};
+
+/** In-flight simulated projectiles, stored as parallel arrays */
+struct FSimulatedProjectiles
+{
+	TArray<FVector> Positions;
+	TArray<FVector> Velocities;
+	TArray<float> RemainingLife;
+	TArray<TWeakObjectPtr<AActor>> Owners;
+	TArray<uint16> TypeIndices;
+
+	/** Sweep covering the next step of each projectile, submitted the frame before */
+	TArray<FTraceHandle> SweepHandles;
+
+	/** Where each projectile's pending sweep stops, so a longer step than it predicted can be covered the rest of the way */
+	TArray<FVector> SweepEnds;
+
+	/** Frame each projectile was launched on. It holds at the muzzle until its first sweep resolves the next frame */
+	TArray<uint64> LaunchFrames;
+
+	int32 Num() const { return Positions.Num(); }
+
+	int32 Add(const FVector& Position, const FVector& Velocity, float Life, AActor* Owner, uint16 TypeIndex);
+	void RemoveAtSwap(int32 Index);
+};
+
+/**
+ * Simulates projectiles that don't need gameplay callbacks without giving each one an actor.
+ * Every frame the manager resolves last frame's sweeps, sweeps whatever part of a longer than predicted step they
+ * didn't reach, integrates everything in one ParallelFor pass, queues async sweeps for the next step and pushes all transforms to one instanced mesh per projectile type.
+ */
+UCLASS()
+class CRAWLINGCHAOS_API UProjectileManagerSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Returns true if projectiles of this class can be simulated without an actor */
+	static bool CanSimulate(TSubclassOf<ACrawlingChaosProjectile> ProjectileClass);
+
+	/** Launch a simulated projectile. Returns false if the class needs a full actor */
+	bool SpawnProjectile(TSubclassOf<ACrawlingChaosProjectile> ProjectileClass, const FVector& Location,
+						 const FRotator& Rotation, AActor* Owner);
+
+	/** Number of simulated projectiles currently in flight */
+	int32 GetNumProjectiles() const { return Projectiles.Num(); }
+
+	/** Broadcast for every simulated projectile impact */
+	FOnSimulatedProjectileImpact OnProjectileImpact;
+
+private:
+	/** Get or register the simulation type for a projectile class */
+	int32 FindOrAddType(TSubclassOf<ACrawlingChaosProjectile> ProjectileClass);
+
+	/** Queue the sweep for a projectile's next step */
+	void SubmitSweep(int32 Index, float DeltaTime);
+
+	/** Sweep a projectile's path right away. Returns true if it hit something */
+	bool SweepNow(int32 Index, const FVector& Start, const FVector& End, FHitResult& OutHit) const;
+
+	/** Push this frame's transforms to the instanced meshes */
+	void UpdateInstances();
+
+	/** Actor that owns the instanced mesh components */
+	UPROPERTY()
+	AActor* RenderActor;
+
+	UPROPERTY()
+	TArray<FSimulatedProjectileType> Types;
+
+	FSimulatedProjectiles Projectiles;
+
+	/** Transform of every projectile this frame, written by the integration pass */
+	TArray<FTransform> Transforms;
+};
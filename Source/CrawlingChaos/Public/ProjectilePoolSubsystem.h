@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "ProjectilePoolSubsystem.generated.h"
+
+class ACrawlingChaosProjectile;
+
+/** Usage counters for a single projectile pool */
+USTRUCT(BlueprintType)
+struct FProjectilePoolStats
+{
+	GENERATED_BODY()
+
+	/** Acquires that were served by a pooled projectile */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Pool)
+	int32 Hits = 0;
+
+	/** Acquires that had to spawn a new projectile */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Pool)
+	int32 Misses = 0;
+
+	/** Projectiles currently in flight */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Pool)
+	int32 InUse = 0;
+
+	/** Most projectiles that have been in flight at once */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Pool)
+	int32 HighWater = 0;
+};
+
+/** Projectiles of a single class waiting to be fired again */
+USTRUCT()
+struct FProjectilePool
+{
+	GENERATED_BODY()
+
+	/** Deactivated projectiles ready to be handed out */
+	UPROPERTY()
+	TArray<ACrawlingChaosProjectile*> Free;
+
+	UPROPERTY()
+	FProjectilePoolStats Stats;
+};
+
+/**
+ * Keeps spent projectiles around so full-auto fire doesn't spawn and destroy an actor per shot.
+ * Projectiles go back to the pool on hit or when their life span runs out.
+ */
+UCLASS()
+class CRAWLINGCHAOS_API UProjectilePoolSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	/** Spawn deactivated projectiles until the pool for this class holds its prewarm count */
+	void Prewarm(TSubclassOf<ACrawlingChaosProjectile> ProjectileClass);
+
+	/** Take a projectile from the pool (or spawn one) and launch it from the given location */
+	ACrawlingChaosProjectile* Acquire(TSubclassOf<ACrawlingChaosProjectile> ProjectileClass, const FVector& Location,
+									  const FRotator& Rotation, AActor* NewOwner);
+
+	/** Deactivate the projectile and put it back in its pool */
+	void Release(ACrawlingChaosProjectile* Projectile);
+
+	/** Get the usage counters for a projectile class */
+	UFUNCTION(BlueprintCallable, Category = "Projectile Pool")
+	FProjectilePoolStats GetStats(TSubclassOf<ACrawlingChaosProjectile> ProjectileClass) const;
+
+	/** Write the counters of every pool to the log */
+	void DumpStats() const;
+
+private:
+	/** Spawn a new, deactivated projectile owned by the pool */
+	ACrawlingChaosProjectile* SpawnPooledProjectile(UClass* ProjectileClass) const;
+
+	/** One pool per projectile class */
+	UPROPERTY()
+	TMap<UClass*, FProjectilePool> Pools;
+};
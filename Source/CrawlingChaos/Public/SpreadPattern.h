@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "UObject/ObjectSaveContext.h"
+
+#include "SpreadPattern.generated.h"
+
+/**
+ * Precomputed pellet offsets for a weapon. The offsets and the jitter stream are baked into the asset, so any pellet
+ * can be regenerated from just the weapon's seed and the shot index; no global RNG is involved.
+ * Offsets are in the unit disc and get scaled by the weapon's horizontal/vertical spread when fired.
+ */
+UCLASS(BlueprintType)
+class CRAWLINGCHAOS_API USpreadPattern : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	USpreadPattern();
+
+	/** Regenerate the offsets and the jitter table from the bake settings */
+	UFUNCTION(CallInEditor, Category = "Spread Pattern")
+	void Bake();
+
+	/** Write the unit-disc offset of every pellet of one shot into OutOffsets */
+	void GetPelletOffsets(uint32 Seed, uint32 ShotIndex, TArrayView<FVector2D> OutOffsets) const;
+
+	/** Mix the weapon seed and a shot index into a single value for a shot */
+	static uint32 HashShot(uint32 Seed, uint32 ShotIndex);
+
+#if WITH_EDITOR
+	virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
+	virtual void PreSave(FObjectPreSaveContext ObjectSaveContext) override;
+
+private:
+	/** Is the baked data in line with the current bake settings? */
+	bool IsBaked() const;
+
+	/** Number of offsets in the pattern */
+	UPROPERTY(EditAnywhere, Category = "Spread Pattern", meta = (ClampMin = 1, ClampMax = 1024))
+	int32 NumOffsets;
+
+	/**
+	 * If true, every shot starts at the first offset, which gives multi-pellet weapons a fixed pattern. If false,
+	 * successive shots walk through the offsets, which gives single-pellet weapons an even spread over time
+	 */
+	UPROPERTY(EditAnywhere, Category = "Spread Pattern")
+	bool bRestartEachShot;
+
+	/** Candidates tried per offset when baking; more gives a more even (bluer) distribution */
+	UPROPERTY(EditAnywhere, Category = "Spread Pattern", meta = (ClampMin = 1, ClampMax = 64))
+	int32 CandidatesPerOffset;
+
+	/** Seed the pattern is baked from */
+	UPROPERTY(EditAnywhere, Category = "Spread Pattern")
+	int32 BakeSeed;
+
+	/** Size of the per-pellet jitter added on top of the offsets, as a fraction of the spread */
+	UPROPERTY(EditAnywhere, Category = "Spread Pattern", meta = (ClampMin = 0, ClampMax = 1))
+	float JitterScale;
+
+	/** Baked pellet offsets in the unit disc, ordered so any prefix is evenly spread */
+	UPROPERTY(VisibleAnywhere, Category = "Spread Pattern|Baked")
+	TArray<FVector2D> Offsets;
+
+	/** Baked jitter offsets in the unit disc, indexed by a hash of the seed, shot and pellet */
+	UPROPERTY(VisibleAnywhere, Category = "Spread Pattern|Baked")
+	TArray<FVector2D> JitterTable;
+
+	/** Settings the baked data came from */
+	UPROPERTY()
+	int32 BakedNumOffsets;
+
+	UPROPERTY()
+	int32 BakedCandidatesPerOffset;
+
+	UPROPERTY()
+	int32 BakedSeed;
+};
@@ -10,16 +10,24 @@
 #include "Enums/FireMode.h"
 #include "Enums/WeaponType.h"
 #include "Item.h"
+#include "WorldCollision.h"
 
 #include "Weapon.generated.h"
 
 // Forward declarations
+class UAnimMontage;
 class USoundCue;
 class ACrawlingChaosProjectile;
 class UNiagaraSystem;
+class UNiagaraComponent;
 class ACrawlingChaosCharacter;
+class USpreadPattern;
+class UWeaponInstance;
 
-/** Weapon data table struct for ease of adding new weapons */
+/**
+ * Weapon data table struct for ease of adding new weapons. Assets are soft references; the weapon asset streamer
+ * loads them while a weapon is owned or one of its pickups is nearby
+ */
 USTRUCT()
 struct FWeaponDataTable : public FTableRowBase
 {
@@ -31,87 +39,160 @@ struct FWeaponDataTable : public FTableRowBase
 
 	/** Type of the weapon */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	EWeaponType WeaponType;
+	EWeaponType WeaponType = EWeaponType::EWT_Shotgun;
 
 	/** How does the weapon propagate damage? */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	EDamageMode DamageMode;
+	EDamageMode DamageMode = EDamageMode::EDM_HITSCAN;
 	
 	/** Offset used to position the gun properly on the screen */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	FVector GunOffset;
+	FVector GunOffset = FVector::ZeroVector;
 
 	/** Type of ammo used */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	EAmmoType AmmoType;
+	EAmmoType AmmoType = EAmmoType::EAT_Pistol;
 
 	/** Amount of ammo you get when picking up the weapon */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 WeaponAmmo;
+	int32 WeaponAmmo = 0;
+
+	/** Damage dealt by each pellet that hits */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Damage = 10.f;
 
-	/** Number of shots per trigger pull */
+	/** Pellets per round, or rounds per trigger pull for burst weapons */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 NumberOfShots;
+	int32 NumberOfShots = 1;
 
 	/** Weapon spread in the horizontal direction */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 HorizontalSpread;
+	int32 HorizontalSpread = 0;
 
 	/** Weapon spread in the vertical direction */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	int32 VerticalSpread;
+	int32 VerticalSpread = 0;
+
+	/** Baked pellet offsets within the spread; pellets are drawn uniformly from the spread without one */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	USpreadPattern* SpreadPattern = nullptr;
 
 	/** Fire mode; i.e. full-auto, semi-auto, burst, etc. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	EFireMode FireMode;
+	EFireMode FireMode = EFireMode::EFM_Semi;
 
 	/** Rate of fire in Rounds Per Minute */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	float AutoFireRate;
+	float AutoFireRate = 600.f;
 
 	/** Item mesh */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USkeletalMesh* ItemMesh;
+	TSoftObjectPtr<USkeletalMesh> ItemMesh;
+
+	/** Static mesh baked from the item mesh in its reference pose; pickups of this type are drawn instanced with it */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSoftObjectPtr<UStaticMesh> PickupStaticMesh;
 
-	/** Texture for the item */
+	/** Texture for the item. Shared by every weapon of the type; per-weapon variation goes through custom primitive data */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UMaterialInstance* MaterialInstance;
+	TSoftObjectPtr<UMaterialInstance> MaterialInstance;
+
+	/** Emissive strength the material reads from the item's custom primitive data */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float Glow = 0.f;
+
+	/** Rarity tint the material reads from the item's custom primitive data */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FLinearColor RarityTint = FLinearColor::White;
 
 	/** Particle system for the muzzle flash */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UParticleSystem* MuzzleFlash;
+	TSoftObjectPtr<UParticleSystem> MuzzleFlash;
 
 	/** Type of projectile to spawn */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TSubclassOf<ACrawlingChaosProjectile> Projectile;
 
+	/** AnimMontage to play each time we fire */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSoftObjectPtr<UAnimMontage> FireAnimation;
+
 	// todo: this will probably just be a montage with a bunch of sections tbh, not a blueprint
 	/** Animation blueprint for pickup, swap, fire, reload, etc. */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	TSubclassOf<UAnimInstance> AnimBP;
+	TSoftClassPtr<UAnimInstance> AnimBP;
 
 	// todo: I probably won't need this
 	/** Icon used in the inventory */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UTexture2D* InventoryIcon;
+	TSoftObjectPtr<UTexture2D> InventoryIcon;
 
 	/** Weapon fire sound */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USoundBase* FireSound;
+	TSoftObjectPtr<USoundBase> FireSound;
+
+	/** Played on a loop in place of FireSound while full-auto fire is at least LoopFireRateThreshold */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSoftObjectPtr<USoundBase> FireLoopSound;
+
+	/** Played when the fire loop ends */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TSoftObjectPtr<USoundBase> FireTailSound;
+
+	/** Rate of fire in RPM from which full-auto fire plays the loop; 0 always plays a sound per round */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float LoopFireRateThreshold = 0.f;
 
 	/** Sound played on pickup */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USoundCue* PickupSound;
+	TSoftObjectPtr<USoundCue> PickupSound;
 
 	/** Sound played on equip */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	USoundCue* EquipSound;
+	TSoftObjectPtr<USoundCue> EquipSound;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UNiagaraSystem* HitParticleSystem;
+	TSoftObjectPtr<UNiagaraSystem> HitParticleSystem;
 
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-	UNiagaraSystem* TracerParticleSystem;
+	TSoftObjectPtr<UNiagaraSystem> TracerParticleSystem;
+
+	/** Collect every soft asset the weapon needs, so they can be streamed in together */
+	void GetStreamedAssets(TArray<FSoftObjectPath>& OutAssets) const;
+};
+
+/** One pellet of a trigger pull, waiting on its camera and muzzle traces */
+struct FPendingPellet
+{
+	/** Far end of the camera ray the pellet was fired along */
+	FVector TraceEnd{FVector::ZeroVector};
+
+	/** Result of the trace from the camera along the pellet direction */
+	FHitResult CameraHit;
+
+	/** Result of the trace from the muzzle towards the end of the camera ray */
+	FHitResult MuzzleHit;
+
+	/** World time the pellet's round was due, which can fall anywhere inside the frame it was fired in */
+	double RoundTime{0.0};
+};
+
+/** Every pellet of the rounds fired in one frame; resolved once all of its async traces have come back */
+struct FPendingFireBatch
+{
+	/** Identifier packed into the trace user data so results can find their batch */
+	uint16 BatchId{0};
+
+	/** Definition of the weapon that fired, which may have been swapped out since */
+	const FWeaponDataTable* Definition{nullptr};
+
+	/** Muzzle location at the time of the trigger pull */
+	FVector MuzzleLocation{FVector::ZeroVector};
+
+	TArray<FPendingPellet> Pellets;
+
+	/** Number of traces that haven't reported back yet */
+	int32 OutstandingTraces{0};
 };
 
 UCLASS()
@@ -123,65 +204,105 @@ public:
 	// Sets default values for this actor's properties
 	AWeapon();
 
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
-	void TraceForHitsAndSpawnAttacks(UWorld* World) const;
+	/** Start firing; the first round goes out on this frame */
+	void PullTrigger();
 
-	/** Fire the weapon */
-	void OnFire();
+	/** Stop firing once the current round (or burst) is done */
+	void ReleaseTrigger();
 
+	/** Drop any queued rounds, e.g. when the weapon is put away */
+	void StopFiring();
+
+	virtual void Tick(float DeltaTime) override;
 
 protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	// Called when the weapon is destroyed or its level unloaded
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 	virtual void OnConstruction(const FTransform& Transform) override;
 
-	/** Called when the area sphere is overlapped */
-	UFUNCTION()
-	void OnSphereOverlap(UPrimitiveComponent* OverlappedComponent,
-		AActor* OtherActor,
-		UPrimitiveComponent* OtherComp,
-		int32 OtherBodyIndex,
-		bool bFromSweep,
-		const FHitResult& SweepResult);
+	virtual void PostInitializeComponents() override;
+
+	/** Point this weapon at the shared definition for its weapon type and hook up the tracer system and material data */
+	void ResolveDefinition();
+
+	/** Show the definition's mesh and material, if the item mesh has been created */
+	void ApplyDefinitionMesh();
+
+	/** Dress the newly created item mesh and move the tracer onto its muzzle */
+	virtual void OnItemMeshCreated() override;
+
+	/** The streamer finished loading a weapon type's assets; pick them up if they're ours */
+	void OnWeaponAssetsLoaded(EWeaponType LoadedWeaponType);
+
+	/** Get the definition's projectiles ready before the first trigger pull */
+	void PrewarmProjectiles() const;
+
+	/** Hand the pickup's ammo, and the weapon if they don't have it yet, to the character that reached it */
+	virtual void OnCollected(ACrawlingChaosCharacter* Collector) override;
 
 	/** Set the item properties based on the current item state. Once the item is picked up,
 	*  we don't have to worry about it going /back/ to the pickup state. It's stuck in the inventory */
 	void SetItemProperties(EItemState NewItemState);
 
-	/** Perform line traces required for weapon fire */
-	FHitResult LineTraceForWeaponFire(const UWorld* World, FVector& MuzzleLocation, FRotator& ProjectileRotation) const;
+	/** Fire every round the scheduler says is due by now */
+	void FireDueRounds();
 
-	/** Spawn weapon projectile (if not hitscan) */
-	void SpawnProjectile(UWorld* World, FVector MuzzleLocation, FRotator ProjectileRotation,
-						 ACrawlingChaosCharacter* Character) const;
+	/** Fire a batch of rounds, each stamped with the time it was due */
+	void OnFire(const TArray<double>& RoundTimes);
+
+	/** Generate the pellet directions from the owner's view and queue async traces for every pellet of these rounds */
+	void TraceForHitsAndSpawnAttacks(UWorld* World, const TArray<double>& RoundTimes, int32 PelletsPerRound);
+
+	/** Called by the world for every finished pellet trace */
+	void OnPelletTraceCompleted(const FTraceHandle& TraceHandle, FTraceDatum& TraceDatum);
+
+	/** All traces of the batch are back; spawn the attacks for each of its pellets */
+	void ResolveFireBatch(UWorld* World, const FPendingFireBatch& Batch);
+
+	/** Spawn a projectile or the hitscan effects for a single resolved pellet */
+	void SpawnAttackForPellet(UWorld* World, const FWeaponDataTable& FiredDefinition, const FVector& MuzzleLocation,
+							  const FVector& Location, const FHitResult& HitResult, float Age);
 
-	/** Reset the fire timer if full auto */
-	void AutoFireReset();
+	/** Hand this frame's tracer beams to the tracer system in one go */
+	void FlushTracers();
+
+	/** Spawn weapon projectile (if not hitscan) */
+	void SpawnProjectile(UWorld* World, const FWeaponDataTable& FiredDefinition, FVector MuzzleLocation,
+						 FRotator ProjectileRotation, ACrawlingChaosCharacter* Character) const;
 public:
 	/////////////////////////////////////////////////////////////////////////////////////////////////////
 	/// Getters
 	
+	/** Get the shared definition this weapon was resolved to */
+	const FWeaponDataTable* GetDefinition() const
+	{
+		return Definition;
+	}
+
 	/** Get the projectile class to spawn */
 	TSubclassOf<ACrawlingChaosProjectile> GetProjectileClass() const
 	{
-		return ProjectileClass;
+		return Definition->Projectile;
 	}
 
-	/** Get the weapon fire sound */
+	/** Get the weapon fire sound, if it's streamed in */
 	USoundBase* GetFireSound() const
 	{
-		return FireSound;
+		return Definition->FireSound.Get();
 	}
 
-	/** Get the weapon fire animation */
+	/** Get the weapon fire animation; the definition's takes priority so one weapon actor can hold any weapon */
 	UAnimMontage* GetFireAnimation() const
 	{
-		return FireAnimation;
+		UAnimMontage* DefinitionAnimation = Definition->FireAnimation.Get();
+		return DefinitionAnimation ? DefinitionAnimation : FireAnimation;
 	}
 
-	/** Get the item mesh */
+	/** Get the item mesh; null until the weapon is equipped or otherwise needs to be seen without a pickup instance */
 	USkeletalMeshComponent *GetItemMesh() const
 	{
 		return ItemMesh;
@@ -190,20 +311,20 @@ public:
 	/** Get the weapon ammo type */
 	EAmmoType GetAmmoType() const
 	{
-		return AmmoType;
+		return Definition->AmmoType;
 	}
 
 	// todo: can probs rename this
 	/** Get the ammo per weapon pickup */
 	int32 GetWeaponAmmo() const
 	{
-		return WeaponAmmo;
+		return Definition->WeaponAmmo;
 	}
 
 	/** Get the mode of weapon fire (burst, full-auto, etc.)*/
 	EFireMode GetFireMode() const
 	{
-		return FireMode;
+		return Definition->FireMode;
 	}
 
 	/** Get the current state of the item */
@@ -218,10 +339,16 @@ public:
 		return WeaponType;
 	}
 
+	/** Set the type of weapon. Only takes effect before the weapon finishes spawning */
+	void SetWeaponType(const EWeaponType NewWeaponType)
+	{
+		WeaponType = NewWeaponType;
+	}
+
 	/** Get the mode of damage (projectile, hitscan) */
 	EDamageMode GetDamageMode() const
 	{
-		return DamageMode;
+		return Definition->DamageMode;
 	}
 
 	/** Get the Rate of Fire stored in the data table, convert to seconds per round and return */
@@ -230,134 +357,78 @@ public:
 	/** Set the new item state */
 	void SetItemState(EItemState NewItemState);
 
-	/** Set the new owner of this weapon */
-	void SetPlayer(ACrawlingChaosCharacter* NewOwner)
+	/** Get the carried weapon this actor is currently standing in for */
+	UWeaponInstance* GetInstance() const
 	{
-		this->Player = NewOwner; 
+		return Instance;
 	}
 
-	void SetStartFiring(const bool bFire)
+	/** Become the given carried weapon, swapping the definition and mesh in place */
+	void SetInstance(UWeaponInstance* NewInstance);
+
+	/** Set the new owner of this weapon */
+	void SetPlayer(ACrawlingChaosCharacter* NewOwner)
 	{
-		bStartFiring = bFire;
+		this->Player = NewOwner; 
 	}
 private:
 	/** Item's current state */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Weapon, meta = (AllowPrivateAccess = true))
 	EItemState ItemState;
-	
-	// todo: fix up the uproperty macros
-	/** Projectile class to spawn */
-	UPROPERTY(EditDefaultsOnly, Category = Weapon, meta = (AllowPrivateAccess = true))
-	TSubclassOf<class ACrawlingChaosProjectile> ProjectileClass;
 
-	/** AnimMontage to play each time we fire */
+	/** AnimMontage to play each time we fire, if the definition doesn't have one */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Weapon, meta = (AllowPrivateAccess = true))
 	UAnimMontage* FireAnimation;
 
-	/** Type of the weapon */
+	/** Type of the weapon, used to look up its definition */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Weapon, meta = (AllowPrivateAccess = true))
 	EWeaponType WeaponType;
 
-	/** How the weapon propagates damage */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Weapon, meta = (AllowPrivateAccess = true))
-	EDamageMode DamageMode;
-	
-	/** Name of the weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Weapon, meta = (AllowPrivateAccess = true))
-	FString ItemName;
-
-	/** Gun muzzle's offset from the characters location */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AllowPrivateAccess = true))
-	FVector GunOffset;
-
-	/** Type of ammo used */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AllowPrivateAccess = true))
-	EAmmoType AmmoType;
-
-	/** Amount of ammo you get when picking up the weapon */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AllowPrivateAccess = true))
-	int32 WeaponAmmo;
-
-	/** Number of shots per trigger pull */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AllowPrivateAccess = true))
-	int32 NumberOfShots;
-
-	/** Fire mode; i.e. full-auto, semi-auto, burst, etc. */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat Stats", meta = (AllowPrivateAccess = "true"))
-	EFireMode FireMode;
-	
-	/** Rate of fire in Rounds Per Minute */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat Stats", meta = (AllowPrivateAccess = "true"))
-	float AutoFireRate;
-
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AllowPrivateAccess = true))
-	USkeletalMesh* Mesh;
-	
-	/** Texture for the item */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AllowPrivateAccess = true))
-	UMaterialInstance* MaterialInstance;
-
-	/** Particle system for the muzzle flash */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AllowPrivateAccess = true))
-	UParticleSystem* MuzzleFlash;
+	/** Persistent tracer system; every beam fired this frame is handed to it as one batch */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Combat, meta = (AllowPrivateAccess = "true"))
+	UNiagaraComponent* TracerComponent;
 
-	/** Animation blueprint for pickup, swap, fire, reload, etc. */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AllowPrivateAccess = true))
-	TSubclassOf<UAnimInstance> AnimBP;
+	/** No longer filled in; weapons share their definition's material and vary it through custom primitive data */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true",
+		DeprecatedProperty, DeprecationMessage = "Weapons no longer get a dynamic material. Use GetOrCreateDynamicMaterial instead"))
+	UMaterialInstanceDynamic* DynamicMaterialInstance;
 
-	/** Icon used in the inventory */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AllowPrivateAccess = true))
-	UTexture2D* InventoryIcon;
+	/** Owner of the weapon */
+	UPROPERTY()
+	ACrawlingChaosCharacter* Player;
 
-	/** Sound to play each time we fire */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Weapon, meta = (AllowPrivateAccess = true))
-	USoundBase* FireSound;
+	/** Carried weapon whose runtime state this actor is using; null for pickups */
+	UPROPERTY()
+	UWeaponInstance* Instance;
 	
-	/** Sound played on pickup */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AllowPrivateAccess = true))
-	USoundCue* PickupSound;
-
-	/** Sound played on equip */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Gameplay, meta = (AllowPrivateAccess = true))
-	USoundCue* EquipSound;
+	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
+	/// Non-UPROPERTY class members
 
-	/** Dynamic instance that can be changed at runtime */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Item Properties", meta = (AllowPrivateAccess = "true"))
-	UMaterialInstanceDynamic* DynamicMaterialInstance;
+	/** Scratch list of the rounds due this frame */
+	TArray<double> DueRoundTimes;
 
-	/** Particle system to spawn on hit */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	UNiagaraSystem* HitParticleSystem;
+	/** Scratch list of the pellet directions generated this frame */
+	TArray<FVector> PelletDirections;
 
-	/** Particle system to spawn on hit */
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = Combat, meta = (AllowPrivateAccess = "true"))
-	UNiagaraSystem* TracerParticleSystem;
+	/** Trigger pulls whose pellet traces are still in flight */
+	TArray<FPendingFireBatch> PendingFireBatches;
 
-	/** Weapon spread in the horizontal direction */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat Stats", meta = (AllowPrivateAccess = "true"))
-	int32 HorizontalSpread;
+	/** Id handed to the next fire batch */
+	uint16 NextFireBatchId;
 
-	/** Weapon spread in the vertical direction */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Combat Stats", meta = (AllowPrivateAccess = "true"))
-	int32 VerticalSpread;
+	/** Delegate handed to the world for every pellet trace */
+	FTraceDelegate PelletTraceDelegate;
 
-	/** Owner of the weapon */
-	UPROPERTY()
-	ACrawlingChaosCharacter* Player;
-	
-	/** Can the weapon fire currently? */
-	UPROPERTY()
-	bool bCanFire;
+	/** Start and end of every tracer beam fired since the last flush */
+	TArray<FVector> TracerBeamStarts;
+	TArray<FVector> TracerBeamEnds;
 
-	/** Is the weapon now firing? */
-	UPROPERTY()
-	bool bStartFiring;
+	/** Frame the beams above were fired in */
+	uint64 TracerBeamFrame;
 
-	/** Timer used to automatically reset and cause the weapon to be fully automatic */
-	UPROPERTY()
-	FTimerHandle WeaponFireTimer;
-	
-	///////////////////////////////////////////////////////////////////////////////////////////////////////////////////
-	/// Non-UPROPERTY class members
+	/** Did the last flush hand any beams to the tracer system? If so, the next one has to clear them */
+	bool bTracerBeamsPending;
 
+	/** Shared, read-only definition for this weapon type, owned by the weapon definition subsystem */
+	const FWeaponDataTable* Definition;
 };
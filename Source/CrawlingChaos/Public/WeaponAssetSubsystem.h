@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "Enums/WeaponType.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "WeaponAssetSubsystem.generated.h"
+
+
+/** Called once a weapon type's assets have finished streaming in */
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnWeaponAssetsLoaded, EWeaponType /*WeaponType*/);
+
+/** Streaming state of one weapon type's assets */
+struct FWeaponAssetSlot
+{
+	/** Keeps the assets loaded while set */
+	TSharedPtr<FStreamableHandle> Handle;
+
+	/** Number of owners holding onto the weapon */
+	int32 PinCount{0};
+
+	/** Is a pickup of this weapon within range of the player? */
+	bool bRelevant{false};
+};
+
+/**
+ * Streams weapon assets in and out. A weapon type's assets are requested asynchronously as soon as one of its
+ * pickups comes within RelevanceRange of the player, stay loaded while anyone owns the weapon, and are released
+ * once neither is true so they can be collected. Pickups are found through the pickup subsystem's spatial hash.
+ */
+UCLASS(config=Game)
+class CRAWLINGCHAOS_API UWeaponAssetSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponAssetSubsystem();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** Keep a weapon type's assets loaded, e.g. while it's in someone's inventory */
+	void PinWeapon(EWeaponType WeaponType);
+
+	/** Let go of a weapon type pinned earlier */
+	void UnpinWeapon(EWeaponType WeaponType);
+
+	/** Returns true if the weapon type's assets are in memory */
+	bool AreAssetsLoaded(EWeaponType WeaponType) const;
+
+	/** Broadcast whenever a weapon type's assets finish streaming in */
+	FOnWeaponAssetsLoaded OnWeaponAssetsLoaded;
+
+private:
+	/** Work out which weapon types have a pickup near the player */
+	void UpdateRelevance();
+
+	/** Request or release a weapon type's assets to match whether anything wants them */
+	void UpdateStreaming(EWeaponType WeaponType);
+
+	/** Called by the streamable manager when a request completes */
+	void OnAssetsStreamed(EWeaponType WeaponType);
+
+	/** Pickups closer than this to the player have their assets streamed in */
+	UPROPERTY(Config)
+	float RelevanceRange;
+
+	/** Pickups stay relevant until they're this many times the relevance range away, so edges don't thrash */
+	UPROPERTY(Config)
+	float ReleaseRangeScale;
+
+	/** Seconds between relevance checks */
+	UPROPERTY(Config)
+	float RelevanceUpdateInterval;
+
+	/** Streaming state, indexed by EWeaponType */
+	TArray<FWeaponAssetSlot> Slots;
+
+	FStreamableManager StreamableManager;
+
+	float TimeSinceRelevanceUpdate;
+};
@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Enums/WeaponType.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "WeaponAudioSubsystem.generated.h"
+
+class UAudioComponent;
+class USoundBase;
+struct FWeaponDataTable;
+
+/** A weapon holding its fire loop while it keeps shooting */
+USTRUCT()
+struct FWeaponFireLoop
+{
+	GENERATED_BODY()
+
+	/** Weapon the loop is attached to */
+	TWeakObjectPtr<AActor> Source;
+
+	/** The weapon's one loop component, reused every time it starts firing again */
+	UPROPERTY()
+	UAudioComponent* Component = nullptr;
+
+	/** Played when the weapon stops */
+	UPROPERTY()
+	USoundBase* TailSound = nullptr;
+
+	EWeaponType WeaponType = EWeaponType::EWT_DefaultMAX;
+
+	/** When the last round went out, and how long the loop may go without one before it ends */
+	double LastRoundTime = 0.0;
+	double Timeout = 0.0;
+
+	bool bPlaying = false;
+};
+
+/** A pooled component for one-shot fire sounds */
+USTRUCT()
+struct FWeaponOneShot
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	UAudioComponent* Component = nullptr;
+
+	/** Weapon type of the sound last played, for the concurrency limit */
+	EWeaponType WeaponType = EWeaponType::EWT_DefaultMAX;
+};
+
+/**
+ * Plays weapon fire audio. Sustained fire faster than a weapon's LoopFireRateThreshold switches to a loop on a
+ * single component per weapon and ends with a tail, instead of one voice per round. Everything else goes through
+ * a fixed pool of one-shot components, and no weapon type may hold more than MaxVoicesPerWeaponType voices at once.
+ */
+UCLASS(config=Game)
+class CRAWLINGCHAOS_API UWeaponAudioSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponAudioSubsystem();
+
+	virtual void Deinitialize() override;
+
+	// UTickableWorldSubsystem interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override;
+	virtual TStatId GetStatId() const override;
+
+	/** The weapon fired its rounds for this frame; play them as one sound, or keep its loop going */
+	void PlayFire(AActor* Source, const FWeaponDataTable& Definition);
+
+	/** The weapon stopped firing; end its loop with the tail if it has one going */
+	void StopFire(AActor* Source);
+
+	/** Number of sounds dropped because their weapon type was out of voices */
+	int32 GetNumDroppedSounds() const { return NumDroppedSounds; }
+
+private:
+	/** Find or start the weapon's loop. Returns false if the weapon type is out of voices */
+	bool KeepLoopPlaying(AActor* Source, const FWeaponDataTable& Definition, USoundBase* LoopSound);
+
+	/** Stop a loop and play its tail where it was */
+	void EndLoop(FWeaponFireLoop& Loop);
+
+	/** Play a sound through the one-shot pool, if the weapon type has a voice left or bLimitVoices is off */
+	void PlayOneShot(USoundBase* Sound, const FVector& Location, EWeaponType WeaponType, bool bLimitVoices = true);
+
+	/** Voices the weapon type is holding right now */
+	int32 CountVoices(EWeaponType WeaponType) const;
+
+	/** Most one-shot components kept at once */
+	UPROPERTY(Config)
+	int32 OneShotPoolSize;
+
+	/** Most voices a single weapon type may play at once, loops and one-shots combined */
+	UPROPERTY(Config)
+	int32 MaxVoicesPerWeaponType;
+
+	/** A loop ends once this many rounds' worth of time passes without a shot */
+	UPROPERTY(Config)
+	float LoopTimeoutRounds;
+
+	/** Seconds a loop takes to fade out under its tail */
+	UPROPERTY(Config)
+	float LoopFadeOutTime;
+
+	UPROPERTY()
+	TArray<FWeaponFireLoop> Loops;
+
+	UPROPERTY()
+	TArray<FWeaponOneShot> OneShots;
+
+	/** Sounds dropped because their weapon type was out of voices */
+	int32 NumDroppedSounds;
+};
@@ -0,0 +1,50 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Enums/WeaponType.h"
+#include "Subsystems/EngineSubsystem.h"
+#include "Weapon.h"
+
+#include "WeaponDefinitionSubsystem.generated.h"
+
+class UDataTable;
+
+/**
+ * Loads the weapon data table once and hands out one shared, read-only definition per weapon type.
+ * Lives on the engine rather than the game instance so editor construction scripts can use it too.
+ */
+UCLASS()
+class CRAWLINGCHAOS_API UWeaponDefinitionSubsystem : public UEngineSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Get the shared definition for the weapon type. Never null, and stays valid for the lifetime of the engine */
+	const FWeaponDataTable* GetDefinition(EWeaponType WeaponType);
+
+	/** Convenience accessor that goes through GEngine; falls back to an empty definition without one */
+	static const FWeaponDataTable* FindDefinition(EWeaponType WeaponType);
+
+	/** Definition used before a weapon has been resolved, or for types missing from the table */
+	static const FWeaponDataTable& GetEmptyDefinition();
+
+private:
+	/** Load the weapon data table and resolve its rows if we haven't yet */
+	void LoadDefinitions();
+
+	/** Copy every row of the table into its slot. Slots are updated in place so handed-out pointers stay valid */
+	void ResolveDefinitions();
+
+	/** The weapon data table everything is resolved from */
+	UPROPERTY()
+	UDataTable* WeaponTable;
+
+	/** One definition per weapon type, indexed by EWeaponType */
+	UPROPERTY()
+	TArray<FWeaponDataTable> Definitions;
+};
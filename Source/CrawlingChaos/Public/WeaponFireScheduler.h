@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Enums/FireMode.h"
+
+/**
+ * Works out when a weapon's rounds are due from the trigger timestamps and the rate of fire, independent of the
+ * frame rate. Every round due by the end of a frame is handed out together, each with its own timestamp.
+ */
+struct CRAWLINGCHAOS_API FWeaponFireScheduler
+{
+	/** The trigger was pulled at Time. Semi-auto and burst pulls during the cooldown are ignored */
+	void PullTrigger(double Time, EFireMode FireMode, int32 BurstLength);
+
+	/** The trigger was let go. Full-auto stops; a burst in progress finishes */
+	void ReleaseTrigger();
+
+	/** Drop anything still queued */
+	void Reset();
+
+	/**
+	 * Append the timestamp of every round due at or before Now, up to MaxRounds of them.
+	 * Once MaxRounds is hit the weapon has run dry, so the rest of the queue is dropped.
+	 * Without a positive SecondsPerRound there is no cooldown: semi-auto and burst rounds are all due at once, and
+	 * full-auto, having nothing to pace it, doesn't fire.
+	 */
+	void CollectDueRounds(double Now, double SecondsPerRound, int32 MaxRounds, TArray<double>& OutRoundTimes);
+
+	/** Returns true while rounds are still queued */
+	bool IsActive() const { return RoundsRemaining != 0; }
+
+private:
+	/** Rounds left to fire; negative means keep going until the trigger is released */
+	int32 RoundsRemaining{0};
+
+	/** Time the next round is due; also enforces the rate of fire between trigger pulls */
+	double NextRoundTime{TNumericLimits<double>::Lowest()};
+};
@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Enums/WeaponType.h"
+#include "UObject/Object.h"
+#include "WeaponFireScheduler.h"
+
+#include "WeaponInstance.generated.h"
+
+struct FWeaponDataTable;
+
+/**
+ * A weapon the character carries. Holds only the weapon's runtime state, so carrying a weapon costs one small
+ * object; the single equipped weapon actor borrows whichever instance is in hand.
+ */
+UCLASS(BlueprintType)
+class CRAWLINGCHAOS_API UWeaponInstance : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponInstance();
+
+	/** Set the instance up as a weapon of the given type */
+	void Initialize(EWeaponType NewWeaponType);
+
+	/** Get the type of weapon */
+	EWeaponType GetWeaponType() const
+	{
+		return WeaponType;
+	}
+
+	/** Get the shared definition for this weapon's type */
+	const FWeaponDataTable* GetDefinition() const
+	{
+		return Definition;
+	}
+
+	/** Get the scheduler that tracks this weapon's queued rounds and cooldown */
+	FWeaponFireScheduler& GetFireScheduler()
+	{
+		return FireScheduler;
+	}
+
+	/** Seed every pellet of this weapon is generated from, along with the shot index */
+	uint32 GetSpreadSeed() const
+	{
+		return SpreadSeed;
+	}
+
+	/** Use a known seed, e.g. one handed out by the server or read from a replay */
+	void SetSpreadSeed(const uint32 NewSeed)
+	{
+		SpreadSeed = NewSeed;
+	}
+
+	/** Index the next round fired will have */
+	uint32 GetShotIndex() const
+	{
+		return ShotIndex;
+	}
+
+	/** Take the index for the next round fired */
+	uint32 ConsumeShotIndex()
+	{
+		return ShotIndex++;
+	}
+
+private:
+	/** Type of the weapon, used to look up its definition */
+	UPROPERTY(VisibleAnywhere, Category = Weapon)
+	EWeaponType WeaponType;
+
+	/** Decides when rounds are due; kept here so the cooldown survives swapping weapons */
+	FWeaponFireScheduler FireScheduler;
+
+	/** Seed for the spread of this weapon's pellets */
+	uint32 SpreadSeed;
+
+	/** Rounds fired so far; together with the seed this regenerates any pellet */
+	uint32 ShotIndex;
+
+	/** Shared, read-only definition for this weapon type, owned by the weapon definition subsystem */
+	const FWeaponDataTable* Definition;
+};
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "Enums/WeaponType.h"
+#include "Subsystems/WorldSubsystem.h"
+
+#include "WeaponPrewarmSubsystem.generated.h"
+
+class UNiagaraSystem;
+class UParticleSystem;
+class USoundBase;
+struct FWeaponDataTable;
+
+/**
+ * Gets every weapon the level can put in the player's hands ready to fire before play starts: the weapons placed
+ * in the level and the player's default weapon. Their assets are loaded, their effects are spawned and simulated
+ * out of sight, pools are filled and fire sounds primed, so the first trigger pull costs the same as any other.
+ * The assets are only held for the warm-up; keeping them loaded afterwards is up to the weapon asset subsystem's
+ * streaming and pins. Time spent on each asset is logged.
+ */
+UCLASS(config=Game)
+class CRAWLINGCHAOS_API UWeaponPrewarmSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	UWeaponPrewarmSubsystem();
+
+	virtual void OnWorldBeginPlay(UWorld& InWorld) override;
+
+private:
+	/** Find every weapon type placed in the level or given to the player on spawn */
+	void GatherWeaponTypes(UWorld& InWorld, TArray<EWeaponType>& OutWeaponTypes) const;
+
+	/** Load and warm up everything a weapon type needs to fire */
+	void PrewarmWeapon(UWorld& InWorld, EWeaponType WeaponType);
+
+	/** Spawn the system out of sight and run it for a few frames so its first real use doesn't have to */
+	void PrewarmNiagaraSystem(UWorld& InWorld, UNiagaraSystem* System) const;
+	void PrewarmParticleSystem(UWorld& InWorld, UParticleSystem* System) const;
+	void PrewarmSound(USoundBase* Sound) const;
+
+	/** Frames effects are simulated for while warming up */
+	UPROPERTY(Config)
+	int32 EffectPrewarmTicks;
+
+	/** Length of each of those frames, in seconds */
+	UPROPERTY(Config)
+	float EffectPrewarmTickDelta;
+
+	/** Idle impact components created for each hit effect */
+	UPROPERTY(Config)
+	int32 ImpactPoolPrewarmCount;
+
+	FStreamableManager StreamableManager;
+};
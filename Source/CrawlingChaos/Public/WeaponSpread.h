@@ -0,0 +1,51 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USpreadPattern;
+
+/** Everything pellet generation needs to know about the camera, captured once per frame */
+struct FFireView
+{
+	/** Where the camera is */
+	FVector Location{FVector::ZeroVector};
+
+	/** Camera forward, right and up axes */
+	FVector Forward{FVector::ForwardVector};
+	FVector Right{FVector::RightVector};
+	FVector Up{FVector::UpVector};
+
+	/** Tangent of half the horizontal field of view */
+	float TanHalfFOV{1.f};
+
+	/** Frame the view was captured in */
+	uint64 Frame{0};
+};
+
+/** Turns a weapon's spread into pellet directions without touching the viewport, the controller or the camera manager */
+struct CRAWLINGCHAOS_API FWeaponSpread
+{
+	/**
+	 * Spread values are tuned in pixels at this half-width (1920 wide), so a weapon keeps the same angular spread
+	 * at any resolution
+	 */
+	static constexpr float ReferenceHalfWidth{960.f};
+
+	/** Convert a spread in reference pixels to an offset in tangent space, i.e. per unit of depth along the view */
+	static float PixelsToTangent(const float Pixels, const float TanHalfFOV)
+	{
+		return Pixels / ReferenceHalfWidth * TanHalfFOV;
+	}
+
+	/**
+	 * Fill OutDirections with the pellet directions of one shot, scaled to the elliptical cone given by the
+	 * horizontal and vertical spread (in reference pixels) around the view forward axis.
+	 * The result depends only on the pattern, the seed and the shot index, so it can be regenerated anywhere.
+	 * Without a pattern, pellets are drawn uniformly from the cone with a stream seeded from the shot.
+	 */
+	static void GeneratePelletDirections(const FFireView& View, float HorizontalSpread, float VerticalSpread,
+										 const USpreadPattern* Pattern, uint32 Seed, uint32 ShotIndex,
+										 TArrayView<FVector> OutDirections);
+};